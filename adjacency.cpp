@@ -0,0 +1,291 @@
+#include "adjacency.h"
+#include <cstring>
+#include <vector>
+
+// SSE2 是 x86-64 的基线，按编译目标启用。AVX2 在 GCC/Clang 下用 target 属性
+// 单独编译，运行时按 CPU 选用；其他编译器只有编译目标本身支持 AVX2 时才启用
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ADJACENCY_SSE2 1
+#endif
+#if defined(__AVX2__) || ((defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)))
+#include <immintrin.h>
+#define ADJACENCY_AVX2 1
+#if defined(__AVX2__)
+#define ADJACENCY_AVX2_TARGET
+#else
+#define ADJACENCY_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+// 每个字节的8个位展开成8个 0/1 字节
+struct UnpackTable {
+    std::uint8_t bytes[256][8];
+
+    UnpackTable()
+    {
+        for (int value = 0; value < 256; ++value) {
+            for (int bit = 0; bit < 8; ++bit) {
+                bytes[value][bit] = (value >> bit) & 1;
+            }
+        }
+    }
+};
+
+const UnpackTable &unpackTable()
+{
+    static const UnpackTable table;
+    return table;
+}
+
+// 向量化循环可以越过行尾读取的余量
+const int Slack = 64;
+
+void unpackRow(const std::uint64_t *words, int cols, std::uint8_t *out)
+{
+    const UnpackTable &table = unpackTable();
+    const int byteCount = (cols + 7) / 8;
+    for (int i = 0; i < byteCount; ++i) {
+        const std::uint8_t value = static_cast<std::uint8_t>(words[i / 8] >> ((i % 8) * 8));
+        std::memcpy(out + i * 8, table.bytes[value], 8);
+    }
+}
+
+// sum[i] = a[i] + b[i] + c[i]，从 start 到 n 逐字节处理（向量循环剩下的尾部）
+void addRowsTail(const std::uint8_t *a, const std::uint8_t *b, const std::uint8_t *c,
+                 std::uint8_t *sum, int n, int start)
+{
+    for (int i = start; i < n; ++i) {
+        sum[i] = static_cast<std::uint8_t>(a[i] + b[i] + c[i]);
+    }
+}
+
+// 横向求和并写入单元格：count = sum[c] + sum[c+1] + sum[c+2] - mine[c+1]，
+// sum 与 mine 的下标0是左侧填充列；从第 start 列逐格处理
+void mergeCountsTail(const std::uint8_t *sum, const std::uint8_t *mine, std::uint8_t *cells, int cols,
+                     int start)
+{
+    for (int c = start; c < cols; ++c) {
+        const int self = mine[c + 1];
+        const int count = self ? 0 : sum[c] + sum[c + 1] + sum[c + 2];
+        cells[c] = static_cast<std::uint8_t>((cells[c] & 0xF0) | count);
+    }
+}
+
+void addRowsScalar(const std::uint8_t *a, const std::uint8_t *b, const std::uint8_t *c,
+                   std::uint8_t *sum, int n)
+{
+    addRowsTail(a, b, c, sum, n, 0);
+}
+
+void mergeCountsScalar(const std::uint8_t *sum, const std::uint8_t *mine, std::uint8_t *cells, int cols)
+{
+    mergeCountsTail(sum, mine, cells, cols, 0);
+}
+
+#if defined(ADJACENCY_SSE2)
+void addRowsSse2(const std::uint8_t *a, const std::uint8_t *b, const std::uint8_t *c,
+                 std::uint8_t *sum, int n)
+{
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+        __m128i vc = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(sum + i),
+                         _mm_add_epi8(_mm_add_epi8(va, vb), vc));
+    }
+    addRowsTail(a, b, c, sum, n, i);
+}
+
+void mergeCountsSse2(const std::uint8_t *sum, const std::uint8_t *mine, std::uint8_t *cells, int cols)
+{
+    int c = 0;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i high = _mm_set1_epi8(static_cast<char>(0xF0));
+    for (; c + 16 <= cols; c += 16) {
+        __m128i left = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sum + c));
+        __m128i mid = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sum + c + 1));
+        __m128i right = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sum + c + 2));
+        __m128i self = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mine + c + 1));
+        __m128i count = _mm_add_epi8(_mm_add_epi8(left, mid), right);
+        __m128i safe = _mm_cmpeq_epi8(self, zero);
+        count = _mm_and_si128(_mm_sub_epi8(count, self), safe);
+        __m128i *dst = reinterpret_cast<__m128i *>(cells + c);
+        __m128i old = _mm_and_si128(_mm_loadu_si128(dst), high);
+        _mm_storeu_si128(dst, _mm_or_si128(old, count));
+    }
+    mergeCountsTail(sum, mine, cells, cols, c);
+}
+#endif
+
+#if defined(ADJACENCY_AVX2)
+ADJACENCY_AVX2_TARGET
+void addRowsAvx2(const std::uint8_t *a, const std::uint8_t *b, const std::uint8_t *c,
+                 std::uint8_t *sum, int n)
+{
+    int i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+        __m256i vc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(c + i));
+        __m256i s = _mm256_add_epi8(_mm256_add_epi8(va, vb), vc);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(sum + i), s);
+    }
+    addRowsTail(a, b, c, sum, n, i);
+}
+
+ADJACENCY_AVX2_TARGET
+void mergeCountsAvx2(const std::uint8_t *sum, const std::uint8_t *mine, std::uint8_t *cells, int cols)
+{
+    int c = 0;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i high = _mm256_set1_epi8(static_cast<char>(0xF0));
+    for (; c + 32 <= cols; c += 32) {
+        __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(sum + c));
+        __m256i mid = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(sum + c + 1));
+        __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(sum + c + 2));
+        __m256i self = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mine + c + 1));
+        __m256i count = _mm256_add_epi8(_mm256_add_epi8(left, mid), right);
+        __m256i safe = _mm256_cmpeq_epi8(self, zero);
+        count = _mm256_and_si256(_mm256_sub_epi8(count, self), safe);
+        __m256i *dst = reinterpret_cast<__m256i *>(cells + c);
+        __m256i old = _mm256_and_si256(_mm256_loadu_si256(dst), high);
+        _mm256_storeu_si256(dst, _mm256_or_si256(old, count));
+    }
+    mergeCountsTail(sum, mine, cells, cols, c);
+}
+#endif
+
+// 一种实现的两个行内核
+struct KernelOps {
+    void (*addRows)(const std::uint8_t *, const std::uint8_t *, const std::uint8_t *, std::uint8_t *, int);
+    void (*mergeCounts)(const std::uint8_t *, const std::uint8_t *, std::uint8_t *, int);
+};
+
+KernelOps kernelOps(Adjacency::Kernel kernel)
+{
+    switch (kernel) {
+#if defined(ADJACENCY_AVX2)
+    case Adjacency::Kernel::Avx2:
+        return {addRowsAvx2, mergeCountsAvx2};
+#endif
+#if defined(ADJACENCY_SSE2)
+    case Adjacency::Kernel::Sse2:
+        return {addRowsSse2, mergeCountsSse2};
+#endif
+    default:
+        return {addRowsScalar, mergeCountsScalar};
+    }
+}
+
+// 本机可用的最快实现，第一次调用时检测一次
+Adjacency::Kernel detectKernel()
+{
+    if (Adjacency::kernelAvailable(Adjacency::Kernel::Avx2)) {
+        return Adjacency::Kernel::Avx2;
+    }
+    if (Adjacency::kernelAvailable(Adjacency::Kernel::Sse2)) {
+        return Adjacency::Kernel::Sse2;
+    }
+    return Adjacency::Kernel::Scalar;
+}
+
+} // namespace
+
+namespace Adjacency {
+
+bool kernelAvailable(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Avx2:
+#if defined(__AVX2__)
+        return true;
+#elif defined(ADJACENCY_AVX2)
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    case Kernel::Sse2:
+#if defined(ADJACENCY_SSE2)
+        return true;
+#else
+        return false;
+#endif
+    case Kernel::Scalar:
+        return true;
+    }
+    return false;
+}
+
+Kernel bestKernel()
+{
+    static const Kernel kernel = detectKernel();
+    return kernel;
+}
+
+void computeCounts(const std::uint64_t *planes, int wordsPerRow, int rows, int cols,
+                   std::uint8_t *cells)
+{
+    computeCounts(planes, wordsPerRow, rows, cols, cells, bestKernel());
+}
+
+void computeCounts(const std::uint64_t *planes, int wordsPerRow, int rows, int cols,
+                   std::uint8_t *cells, Kernel kernel)
+{
+    if (rows <= 0 || cols <= 0) {
+        return;
+    }
+    const KernelOps ops = kernelOps(kernelAvailable(kernel) ? kernel : Kernel::Scalar);
+
+    // 三行滚动的字节行，两侧各留一列零填充；再加一行全零用于上下边界
+    const int width = cols + 2;
+    const int stride = width + Slack;
+    std::vector<std::uint8_t> buffer(static_cast<size_t>(stride) * 5, 0);
+    std::uint8_t *zeroRow = buffer.data();
+    std::uint8_t *rowsBuf[3] = {buffer.data() + stride, buffer.data() + stride * 2,
+                                buffer.data() + stride * 3};
+    std::uint8_t *sum = buffer.data() + stride * 4;
+
+    std::uint8_t *prev = zeroRow;
+    std::uint8_t *cur = rowsBuf[0];
+    unpackRow(planes, cols, cur + 1);
+    int nextSlot = 1;
+
+    for (int row = 0; row < rows; ++row) {
+        std::uint8_t *next = zeroRow;
+        if (row + 1 < rows) {
+            next = rowsBuf[nextSlot];
+            nextSlot = (nextSlot + 1) % 3;
+            unpackRow(planes + static_cast<size_t>(row + 1) * wordsPerRow, cols, next + 1);
+        }
+
+        ops.addRows(prev, cur, next, sum, width);
+        ops.mergeCounts(sum, cur, cells + static_cast<size_t>(row) * cols, cols);
+
+        prev = cur;
+        cur = next;
+    }
+}
+
+const char *kernelName(Kernel kernel)
+{
+    switch (kernel) {
+    case Kernel::Avx2:
+        return "avx2";
+    case Kernel::Sse2:
+        return "sse2";
+    case Kernel::Scalar:
+        break;
+    }
+    return "scalar";
+}
+
+const char *kernelName()
+{
+    return kernelName(bestKernel());
+}
+
+} // namespace Adjacency
@@ -0,0 +1,38 @@
+#ifndef ADJACENCY_H
+#define ADJACENCY_H
+
+#include <cstdint>
+
+// 相邻地雷计数内核。地雷布局按行存成位平面：每行 wordsPerRow 个64位字，
+// 第 c 列对应第 c/64 个字的第 c%64 位，超出列数的位必须为0。
+namespace Adjacency {
+
+inline int wordsPerRow(int cols) { return (cols + 63) / 64; }
+
+enum class Kernel {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+// 本机能否运行该实现（AVX2 在运行时检测 CPU）
+bool kernelAvailable(Kernel kernel);
+
+// 本机可用的最快实现
+Kernel bestKernel();
+
+// 计算每个单元格周围的地雷数并写入 cells 的低4位（地雷格写0），高4位保持不变。
+// 行展开成带零填充的字节行后用移位相加求和，边界处没有分支；
+// 默认使用 bestKernel()，指定的实现不可用时退回标量实现。各实现结果完全相同
+void computeCounts(const std::uint64_t *planes, int wordsPerRow, int rows, int cols,
+                   std::uint8_t *cells);
+void computeCounts(const std::uint64_t *planes, int wordsPerRow, int rows, int cols,
+                   std::uint8_t *cells, Kernel kernel);
+
+// 实现名称，用于基准测试输出；不带参数时为 bestKernel() 的名称
+const char *kernelName(Kernel kernel);
+const char *kernelName();
+
+} // namespace Adjacency
+
+#endif // ADJACENCY_H
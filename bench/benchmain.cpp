@@ -0,0 +1,439 @@
+#include "benchrunner.h"
+#include "guibench.h"
+#include "boardengine.h"
+#include "adjacency.h"
+#include "solver.h"
+#include "probability.h"
+#include "noguess.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "boardcorpus.h"
+#include "undolog.h"
+#include "chunkedboard.h"
+#include "rng.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+namespace {
+
+std::string sizeParam(int rows, int cols)
+{
+    return std::to_string(rows) + "x" + std::to_string(cols);
+}
+
+// 每3x3区域中心一颗地雷，绝大多数安全格都带数字，揭开时不会连锁展开
+std::vector<int> latticeMines(int rows, int cols)
+{
+    std::vector<int> mines;
+    for (int r = 1; r < rows; r += 3) {
+        for (int c = 1; c < cols; c += 3) {
+            mines.push_back(r * cols + c);
+        }
+    }
+    return mines;
+}
+
+// 逐个揭开所有安全格：每次揭开都要判断胜负，
+// 若胜负判断是常数时间，则每次操作耗时不随棋盘大小增长
+void benchWinDetection(BenchRunner &runner, int rows, int cols)
+{
+    BoardEngine engine;
+    const std::vector<int> mines = latticeMines(rows, cols);
+    runner.run("reveal_win_detection", sizeParam(rows, cols),
+               [&] {
+                   engine.reset(rows, cols, 0);
+                   engine.setMineLayout(mines);
+               },
+               [&] {
+                   long long reveals = 0;
+                   for (int r = 0; r < rows; ++r) {
+                       for (int c = 0; c < cols; ++c) {
+                           if (!engine.isMine(r, c) && !engine.isRevealed(r, c)) {
+                               engine.revealCell(r, c);
+                               ++reveals;
+                           }
+                       }
+                   }
+                   return reveals;
+               });
+}
+
+// 反复标记/取消标记，地雷计数器为常数时间
+void benchFlagToggle(BenchRunner &runner, int rows, int cols)
+{
+    BoardEngine engine;
+    const std::vector<int> mines = latticeMines(rows, cols);
+    runner.run("flag_toggle", sizeParam(rows, cols),
+               [&] {
+                   engine.reset(rows, cols, 0);
+                   engine.setMineLayout(mines);
+               },
+               [&] {
+                   long long toggles = 0;
+                   for (int pass = 0; pass < 2; ++pass) {
+                       for (int r = 0; r < rows; ++r) {
+                           for (int c = 0; c < cols; ++c) {
+                               engine.toggleFlag(r, c);
+                               ++toggles;
+                           }
+                       }
+                   }
+                   return toggles;
+               });
+}
+
+// 只有一颗地雷的大棋盘，一次点击展开几乎整个棋盘
+void benchRevealCascade(BenchRunner &runner, int rows, int cols)
+{
+    BoardEngine engine;
+    runner.run("reveal_cascade", sizeParam(rows, cols) + " single mine",
+               [&] {
+                   engine.reset(rows, cols, 0);
+                   engine.setMineLayout({rows * cols - 1}); // 右下角
+               },
+               [&] {
+                   return static_cast<long long>(engine.revealCell(0, 0).size());
+               });
+}
+
+// 放置地雷（含相邻计数），密度越高越能体现采样算法的差异
+void benchPlaceMines(BenchRunner &runner, int rows, int cols, int mines)
+{
+    BoardEngine engine;
+    std::uint64_t seed = 1;
+    runner.run("place_mines", sizeParam(rows, cols) + " mines=" + std::to_string(mines),
+               nullptr,
+               [&] {
+                   const int boards = 1000;
+                   for (int i = 0; i < boards; ++i) {
+                       engine.reset(rows, cols, mines);
+                       engine.placeMines(rows / 2, cols / 2, seed++);
+                   }
+                   return static_cast<long long>(boards);
+               });
+}
+
+// 整个棋盘的相邻地雷计数（向量化内核）
+void benchAdjacency(BenchRunner &runner, int rows, int cols, int mines)
+{
+    BoardEngine engine;
+    engine.reset(rows, cols, mines);
+    engine.placeMines(0, 0, 1);
+    runner.run("adjacent_counts", sizeParam(rows, cols) + " " + Adjacency::kernelName(),
+               nullptr,
+               [&] {
+                   engine.calculateAdjacentMines();
+                   return static_cast<long long>(engine.cellCount());
+               });
+}
+
+// 开局后对前沿求解一次：耗时只与前沿大小有关，与棋盘大小无关
+void benchSolver(BenchRunner &runner, int rows, int cols, int mines)
+{
+    BoardEngine engine;
+    engine.reset(rows, cols, mines);
+    engine.placeMines(rows / 2, cols / 2, 1);
+    engine.revealCell(rows / 2, cols / 2);
+    Solver solver(engine);
+    solver.rebuild();
+    runner.run("solver_frontier", sizeParam(rows, cols) + "/" + std::to_string(mines)
+                   + " frontier " + std::to_string(solver.frontierSize()),
+               nullptr,
+               [&] {
+                   solver.solve();
+                   return static_cast<long long>(solver.frontierSize());
+               });
+}
+
+// 开局后计算前沿概率：每次迭代前清空缓存，测的是完整的并行枚举
+void benchProbability(BenchRunner &runner, int rows, int cols, int mines)
+{
+    BoardEngine engine;
+    engine.reset(rows, cols, mines);
+    engine.placeMines(rows / 2, cols / 2, 1);
+    engine.revealCell(rows / 2, cols / 2);
+    Solver solver(engine);
+    solver.rebuild();
+    solver.solve();
+    ProbabilityEngine probability;
+    runner.run("probability", sizeParam(rows, cols) + "/" + std::to_string(mines),
+               [&] { probability.clearCache(); },
+               [&] {
+                   return static_cast<long long>(probability.compute(engine, solver.constraints()).cells.size());
+               });
+}
+
+// 生成一局无猜棋盘（首次点击在中央），参数中附带预热时统计的接受率
+void benchNoGuess(BenchRunner &runner, const std::string &preset, int rows, int cols, int mines)
+{
+    NoGuessGenerator generator;
+    std::uint64_t seed = 0;
+    for (int i = 0; i < 20; ++i) {
+        generator.generate(rows, cols, mines, rows / 2, cols / 2, 1000 + i, &seed);
+    }
+    const NoGuessGenerator::Stats warmup = generator.stats(rows, cols, mines);
+    char accept[32];
+    std::snprintf(accept, sizeof(accept), " accept %.1f%%", warmup.acceptanceRate() * 100);
+    std::uint64_t baseSeed = 0;
+    runner.run("noguess_generate", preset + accept,
+               [&] { ++baseSeed; },
+               [&] {
+                   generator.generate(rows, cols, mines, rows / 2, cols / 2, baseSeed, &seed);
+                   return 1LL;
+               });
+}
+
+// 无界面回放：格子布局上先标记全部地雷，再逐个揭开所有安全格
+void benchReplay(BenchRunner &runner, int rows, int cols)
+{
+    BoardEngine engine;
+    engine.reset(rows, cols, 0);
+    engine.setMineLayout(latticeMines(rows, cols));
+
+    Replay replay;
+    replay.begin(rows, cols, engine.mineCount());
+    replay.setMineLayout(engine);
+    std::int64_t tick = 0;
+    for (int index = 0; index < engine.cellCount(); ++index) {
+        if (engine.cells()[index] & BoardEngine::MineBit) {
+            replay.append(tick++, Replay::Flag, index);
+        }
+    }
+    for (int index = 0; index < engine.cellCount(); ++index) {
+        if (!(engine.cells()[index] & BoardEngine::MineBit)) {
+            replay.append(tick++, Replay::Reveal, index);
+        }
+    }
+
+    const std::size_t bytes = replay.serialize().size();
+    runner.run("replay_playback", sizeParam(rows, cols) + " " + std::to_string(bytes) + " bytes",
+               nullptr,
+               [&] { return replay.play(engine); });
+}
+
+// 对局存档：进行到一半的棋盘（已展开、部分插旗）序列化和从缓冲区恢复
+void benchSnapshot(BenchRunner &runner, int rows, int cols, int mines)
+{
+    BoardEngine engine;
+    engine.reset(rows, cols, mines);
+    engine.placeMines(rows / 2, cols / 2, 1);
+    engine.revealCell(rows / 2, cols / 2);
+    for (int index = 0; index < engine.cellCount(); index += 7) {
+        if (!(engine.cells()[index] & BoardEngine::RevealedBit)) {
+            engine.toggleFlag(index / cols, index % cols);
+        }
+    }
+    engine.clearChanges();
+
+    Replay replay;
+    replay.begin(rows, cols, mines);
+    replay.setSeed(rows / 2, cols / 2, 1);
+    replay.append(0, Replay::Reveal, engine.indexOf(rows / 2, cols / 2));
+    const GameSnapshot::Info info;
+    const std::vector<std::uint8_t> data = GameSnapshot::save(engine, info, replay);
+
+    const std::string param = sizeParam(rows, cols) + " " + std::to_string(data.size()) + " bytes";
+    runner.run("snapshot_save", param, nullptr,
+               [&] { return GameSnapshot::save(engine, info, replay).size(); });
+
+    BoardEngine loaded;
+    GameSnapshot::Info loadedInfo;
+    Replay loadedReplay;
+    runner.run("snapshot_load", param, nullptr,
+               [&] { return GameSnapshot::load(data.data(), data.size(), &loaded, &loadedInfo, &loadedReplay); });
+}
+
+// 撤销历史：记录一次展开整个棋盘的揭开（含编码），以及撤销再重做这一步。
+// 变更集每次清空，只测量撤销历史本身
+void benchUndo(BenchRunner &runner, int rows, int cols)
+{
+    BoardEngine engine;
+    UndoLog undo(UndoLog::DefaultCapacity);
+    runner.run("undo_record_cascade", sizeParam(rows, cols) + " single mine",
+               [&] {
+                   engine.reset(rows, cols, 0);
+                   engine.setMineLayout({rows * cols - 1});
+                   undo.clear();
+               },
+               [&] {
+                   undo.begin(engine);
+                   engine.revealCell(0, 0);
+                   undo.commit(engine);
+                   engine.clearChanges();
+                   return static_cast<long long>(undo.memoryUsed());
+               });
+
+    const std::string param = sizeParam(rows, cols) + " " + std::to_string(undo.memoryUsed()) + " bytes";
+    runner.run("undo_redo_cascade", param, nullptr, [&] {
+        undo.undo(engine);
+        undo.redo(engine);
+        engine.clearChanges();
+        return static_cast<long long>(engine.hiddenSafeCells());
+    });
+}
+
+// 棋盘库：在临时文件中写入 boards 块高级棋盘并建索引，
+// 测量按 3BV 区间随机取一块（两次二分查找）以及取出后放入引擎
+void benchCorpus(BenchRunner &runner, int boards)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "minesweeper_bench.mscorpus").string();
+    std::remove(path.c_str());
+    {
+        BoardCorpusWriter writer;
+        writer.open(path, 16 * 30);
+        BoardEngine engine;
+        for (int i = 0; i < boards; ++i) {
+            engine.reset(16, 30, 99);
+            engine.placeMines(8, 15, mix64(i + 1));
+            // 3BV 只影响索引的排列，这里用伪随机值代替实际计算
+            writer.append(engine, 8, 15, 80 + static_cast<int>(mix64(i) % 120), mix64(i + 1));
+        }
+        writer.close();
+    }
+    BoardCorpus::buildIndex(path);
+
+    BoardCorpus corpus;
+    corpus.open(path);
+    BoardCorpus::Query query;
+    query.rows = 16;
+    query.cols = 30;
+    query.mines = 99;
+    query.minBbbv = 120;
+    query.maxBbbv = 150;
+    const std::string param = std::to_string(corpus.boardCount()) + " boards, "
+        + std::to_string(corpus.count(query)) + " matching";
+
+    std::uint64_t random = 1;
+    BoardCorpus::Board board;
+    runner.run("corpus_pick", param, nullptr,
+               [&] { return corpus.pick(query, mix64(random++), &board) ? board.bbbv : -1; });
+    BoardEngine engine;
+    runner.run("corpus_pick_load", param, nullptr, [&] {
+        corpus.pick(query, mix64(random++), &board);
+        BoardCorpus::load(board, &engine);
+        return engine.mineCount();
+    });
+
+    corpus.close();
+    std::remove(path.c_str());
+    std::remove(BoardCorpus::indexPath(path).c_str());
+}
+
+// 无尽模式：跨块的开局展开；以及沿一行逐块完全解开（安全格揭开、地雷标记），
+// 每解开一块就压缩身后已解开的块；参数里记录最后常驻和压缩的块数
+void benchEndless(BenchRunner &runner, double density, int chunks, int keepRadius)
+{
+    ChunkedBoard board;
+    std::uint64_t seed = 1;
+    runner.run("endless_open", "density=" + std::to_string(density).substr(0, 4), nullptr, [&] {
+        board.reset(seed++, density);
+        return static_cast<long long>(board.revealCell(0, 0).size());
+    });
+
+    const int size = ChunkedBoard::ChunkSize;
+    runner.run("endless_explore",
+               std::to_string(chunks) + " chunks keep=" + std::to_string(keepRadius),
+               [&] { board.reset(seed++, density); },
+               [&] {
+                   board.revealCell(0, 0);
+                   for (int chunk = 0; chunk < chunks; ++chunk) {
+                       for (int r = 0; r < size; ++r) {
+                           for (int c = chunk * size; c < (chunk + 1) * size; ++c) {
+                               if (board.isMine(r, c)) {
+                                   if (!(board.cellAt(r, c) & BoardEngine::FlaggedBit)) {
+                                       board.toggleFlag(r, c);
+                                   }
+                               } else {
+                                   board.revealCell(r, c);
+                               }
+                           }
+                       }
+                       board.compact(0, chunk * size, keepRadius);
+                   }
+                   return static_cast<long long>(board.revealedCount());
+               });
+
+    const std::string param = std::to_string(board.residentChunks()) + " resident, "
+        + std::to_string(board.compressedChunks()) + " compressed, "
+        + std::to_string(board.memoryUsage()) + " bytes";
+    runner.run("endless_cell_at", param, nullptr, [&] {
+        long long revealed = 0;
+        for (int c = 0; c < chunks * size; ++c) {
+            revealed += (board.cellAt(size / 2, c) & BoardEngine::RevealedBit) ? 1 : 0;
+        }
+        return revealed;
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    bool json = false;
+    bool gui = true;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if (std::strcmp(argv[i], "--no-gui") == 0) {
+            gui = false;
+        }
+    }
+
+    BenchRunner runner;
+
+    benchWinDetection(runner, 16, 30);
+    benchWinDetection(runner, 100, 100);
+    benchWinDetection(runner, 1000, 1000);
+
+    benchFlagToggle(runner, 16, 30);
+    benchFlagToggle(runner, 1000, 1000);
+
+    benchRevealCascade(runner, 2000, 2000);
+
+    benchPlaceMines(runner, 16, 30, 99);
+    benchPlaceMines(runner, 30, 30, 30 * 30 - 9);
+    for (int percent : {5, 20, 50, 80}) {
+        benchPlaceMines(runner, 100, 100, 100 * 100 * percent / 100);
+    }
+
+    benchAdjacency(runner, 16, 30, 99);
+    benchAdjacency(runner, 1000, 1000, 200000);
+    benchAdjacency(runner, 10000, 10000, 20000000);
+
+    benchSolver(runner, 16, 30, 99);
+    benchSolver(runner, 1000, 1000, 150000);
+
+    benchProbability(runner, 16, 30, 99);
+    benchProbability(runner, 1000, 1000, 150000);
+
+    benchNoGuess(runner, "beginner 9x9/10", 9, 9, 10);
+    benchNoGuess(runner, "intermediate 16x16/40", 16, 16, 40);
+    benchNoGuess(runner, "expert 16x30/99", 16, 30, 99);
+
+    benchReplay(runner, 16, 30);
+    benchReplay(runner, 1000, 1000);
+
+    benchSnapshot(runner, 16, 30, 99);
+    benchSnapshot(runner, 1000, 1000, 150000);
+
+    benchCorpus(runner, 200000);
+
+    benchUndo(runner, 16, 30);
+    benchUndo(runner, 1000, 1000);
+
+    benchEndless(runner, 0.12, 64, 1);
+
+    if (gui) {
+        runGuiBenchmarks(runner, argc, argv);
+    }
+
+    if (json) {
+        runner.writeJson(std::cout);
+    } else {
+        runner.writeText(std::cout);
+    }
+    return 0;
+}
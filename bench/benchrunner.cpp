@@ -0,0 +1,55 @@
+#include "benchrunner.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+void BenchRunner::run(const std::string &name, const std::string &params,
+                      const std::function<void()> &setup,
+                      const std::function<long long()> &body)
+{
+    std::vector<double> times;
+    long long operations = 0;
+    for (int i = 0; i < m_repetitions; ++i) {
+        if (setup) {
+            setup();
+        }
+        auto start = std::chrono::steady_clock::now();
+        operations = body();
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+    Result result;
+    result.name = name;
+    result.params = params;
+    result.operations = operations;
+    result.medianMs = times[times.size() / 2];
+    result.nsPerOperation = operations > 0 ? result.medianMs * 1e6 / operations : 0.0;
+    m_results.push_back(result);
+}
+
+void BenchRunner::writeJson(std::ostream &out) const
+{
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < m_results.size(); ++i) {
+        const Result &r = m_results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"params\": \"" << r.params
+            << "\", \"operations\": " << r.operations
+            << ", \"median_ms\": " << std::setprecision(6) << r.medianMs
+            << ", \"ns_per_op\": " << r.nsPerOperation << "}"
+            << (i + 1 < m_results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
+
+void BenchRunner::writeText(std::ostream &out) const
+{
+    for (const Result &r : m_results) {
+        out << std::left << std::setw(28) << r.name << std::setw(24) << r.params
+            << std::right << std::fixed << std::setprecision(3)
+            << std::setw(12) << r.medianMs << " ms"
+            << std::setw(14) << std::setprecision(1) << r.nsPerOperation << " ns/op\n";
+        out.unsetf(std::ios::fixed);
+    }
+}
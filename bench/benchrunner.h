@@ -0,0 +1,37 @@
+#ifndef BENCHRUNNER_H
+#define BENCHRUNNER_H
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 极简的基准测试运行器：每个用例重复多次取中位数，结果可输出为 JSON
+class BenchRunner
+{
+public:
+    struct Result {
+        std::string name;
+        std::string params;
+        long long operations = 0;  // 单次运行执行的操作次数
+        double medianMs = 0.0;     // 单次运行耗时的中位数
+        double nsPerOperation = 0.0;
+    };
+
+    explicit BenchRunner(int repetitions = 5) : m_repetitions(repetitions) {}
+
+    // setup 不计时；body 计时并返回本次执行的操作次数
+    void run(const std::string &name, const std::string &params,
+             const std::function<void()> &setup,
+             const std::function<long long()> &body);
+
+    const std::vector<Result> &results() const { return m_results; }
+    void writeJson(std::ostream &out) const;
+    void writeText(std::ostream &out) const;
+
+private:
+    int m_repetitions;
+    std::vector<Result> m_results;
+};
+
+#endif // BENCHRUNNER_H
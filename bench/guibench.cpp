@@ -0,0 +1,125 @@
+#include "guibench.h"
+#include "boardengine.h"
+#include "boardview.h"
+#include "debugwindow.h"
+#include <QApplication>
+#include <QImage>
+#include <string>
+
+namespace {
+
+std::string sizeParam(int rows, int cols)
+{
+    return std::to_string(rows) + "x" + std::to_string(cols);
+}
+
+// 典型的对局中途局面：从中央展开一片，每7颗地雷标记一颗
+void prepareBoard(BoardEngine &engine, int rows, int cols, int mines)
+{
+    engine.reset(rows, cols, mines);
+    engine.placeMines(rows / 2, cols / 2, 1);
+    engine.revealCell(rows / 2, cols / 2);
+    int seen = 0;
+    for (int index = 0; index < engine.cellCount(); ++index) {
+        if ((engine.cells()[index] & BoardEngine::MineBit) && seen++ % 7 == 0) {
+            engine.toggleFlag(index / cols, index % cols);
+        }
+    }
+    engine.clearChanges();
+}
+
+// 视口整帧绘制；cellSize 为0时按视口自适应（大棋盘退化为粗略绘制）
+void benchBoardPaint(BenchRunner &runner, int rows, int cols, int mines, int cellSize)
+{
+    BoardEngine engine;
+    prepareBoard(engine, rows, cols, mines);
+
+    BoardView view;
+    view.setEngine(&engine);
+    view.resize(960, 640);
+    view.show();
+    QApplication::processEvents();
+    if (cellSize > 0) {
+        view.setCellSize(cellSize, view.viewport()->rect().center());
+    }
+
+    QImage frame(view.viewport()->size(), QImage::Format_RGB32);
+    runner.run("board_paint", sizeParam(rows, cols) + " cell=" + std::to_string(view.cellSize()),
+               nullptr,
+               [&] {
+                   const int frames = 20;
+                   for (int i = 0; i < frames; ++i) {
+                       view.viewport()->render(&frame);
+                   }
+                   return static_cast<long long>(frames);
+               });
+}
+
+// 调试窗口整幅重建，以及只改写变化像素的增量刷新
+void benchDebugWindow(BenchRunner &runner, int rows, int cols, int mines)
+{
+    BoardEngine engine;
+    prepareBoard(engine, rows, cols, mines);
+
+    DebugWindow window(&engine);
+    window.show();
+    QApplication::processEvents();
+
+    runner.run("debug_refresh", sizeParam(rows, cols),
+               nullptr,
+               [&] {
+                   const int refreshes = 10;
+                   for (int i = 0; i < refreshes; ++i) {
+                       window.updateDisplay();
+                   }
+                   return static_cast<long long>(refreshes) * engine.cellCount();
+               });
+
+    // 每轮切换一批标记，变更集大小与棋盘无关
+    const int batch = qMin(1000, engine.cellCount());
+    runner.run("debug_apply_changes", sizeParam(rows, cols) + " flags=" + std::to_string(batch),
+               [&] {
+                   engine.clearChanges();
+                   int toggled = 0;
+                   for (int index = 0; index < engine.cellCount() && toggled < batch; ++index) {
+                       if (!(engine.cells()[index] & BoardEngine::RevealedBit)) {
+                           engine.toggleFlag(index / cols, index % cols);
+                           ++toggled;
+                       }
+                   }
+               },
+               [&] {
+                   window.applyChanges(engine.changes());
+                   return static_cast<long long>(engine.changes().cells.size());
+               });
+
+    QImage frame(window.size(), QImage::Format_RGB32);
+    runner.run("debug_paint", sizeParam(rows, cols),
+               nullptr,
+               [&] {
+                   const int frames = 20;
+                   for (int i = 0; i < frames; ++i) {
+                       window.render(&frame);
+                   }
+                   return static_cast<long long>(frames);
+               });
+}
+
+} // namespace
+
+void runGuiBenchmarks(BenchRunner &runner, int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    benchBoardPaint(runner, 16, 30, 99, 0);
+    benchBoardPaint(runner, 100, 100, 2000, 0);
+    benchBoardPaint(runner, 1000, 1000, 150000, 0);
+    benchBoardPaint(runner, 1000, 1000, 150000, 30);
+
+    benchDebugWindow(runner, 16, 30, 99);
+    benchDebugWindow(runner, 100, 100, 2000);
+    benchDebugWindow(runner, 1000, 1000, 150000);
+}
@@ -0,0 +1,10 @@
+#ifndef GUIBENCH_H
+#define GUIBENCH_H
+
+#include "benchrunner.h"
+
+// 绘制相关的用例：游戏板视图整帧绘制和调试窗口刷新。
+// 在 offscreen 平台上运行（未指定 QT_QPA_PLATFORM 时自动设置），不需要显示器
+void runGuiBenchmarks(BenchRunner &runner, int argc, char *argv[]);
+
+#endif // GUIBENCH_H
@@ -0,0 +1,394 @@
+#include "boardcorpus.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <tuple>
+
+namespace {
+
+const char DataMagic[4] = {'M', 'S', 'B', 'C'};
+const char IndexMagic[4] = {'M', 'S', 'B', 'I'};
+
+struct FileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t stride;   // 每条记录的字节数，8的倍数
+    std::uint32_t reserved;
+};
+
+struct RecordHeader {
+    std::uint32_t rows;
+    std::uint32_t cols;
+    std::uint32_t mines;
+    std::uint32_t bbbv;
+    std::uint32_t openRow;
+    std::uint32_t openCol;
+    std::uint64_t seed;     // 生成棋盘用的种子，只用于追溯来源
+};
+
+struct IndexHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t stride;   // 与数据文件一致，用于发现不匹配的索引
+    std::uint32_t reserved;
+    std::uint64_t count;
+};
+
+static_assert(sizeof(FileHeader) % 8 == 0 && sizeof(RecordHeader) % 8 == 0,
+              "corpus records must stay 8-byte aligned");
+
+inline std::size_t strideFor(int maxCells)
+{
+    return sizeof(RecordHeader) + (static_cast<std::size_t>(maxCells) + 63) / 64 * 8;
+}
+
+inline std::uint64_t capacityCells(std::size_t stride)
+{
+    return static_cast<std::uint64_t>(stride - sizeof(RecordHeader)) * 8;
+}
+
+bool validStride(std::uint32_t stride)
+{
+    return stride > sizeof(RecordHeader) && stride % 8 == 0;
+}
+
+// 位图前 cells 位中的地雷数；cells 之后的位不属于棋盘，置位时返回 -1
+int countMines(const std::uint64_t *bits, std::uint64_t cells)
+{
+    int count = 0;
+    const std::uint64_t words = (cells + 63) / 64;
+    for (std::uint64_t i = 0; i < words; ++i) {
+        std::uint64_t word = bits[i];
+        const std::uint64_t used = std::min<std::uint64_t>(64, cells - i * 64);
+        if (used < 64 && (word >> used) != 0) {
+            return -1;
+        }
+        for (; word; word &= word - 1) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+// 索引项：排序键加上记录序号
+struct BoardCorpus::Entry {
+    std::uint32_t rows;
+    std::uint32_t cols;
+    std::uint32_t mines;
+    std::uint32_t bbbv;
+    std::uint32_t openRow;
+    std::uint32_t openCol;
+    std::uint32_t record;
+
+    auto key() const { return std::tie(rows, cols, mines, bbbv, openRow, openCol); }
+};
+
+bool BoardCorpus::open(const std::string &path)
+{
+    close();
+    if (!m_data.open(path) || !m_index.open(indexPath(path))) {
+        close();
+        return false;
+    }
+
+    FileHeader file;
+    IndexHeader index;
+    if (m_data.size() < sizeof(FileHeader) || m_index.size() < sizeof(IndexHeader)) {
+        close();
+        return false;
+    }
+    std::memcpy(&file, m_data.data(), sizeof(FileHeader));
+    std::memcpy(&index, m_index.data(), sizeof(IndexHeader));
+    if (std::memcmp(file.magic, DataMagic, sizeof(DataMagic)) != 0 || file.version != Version
+        || !validStride(file.stride) || std::memcmp(index.magic, IndexMagic, sizeof(IndexMagic)) != 0
+        || index.version != Version || index.stride != file.stride
+        || m_index.size() != sizeof(IndexHeader) + index.count * sizeof(Entry)) {
+        close();
+        return false;
+    }
+
+    // 数据文件末尾可能有写到一半的记录，不计入
+    m_stride = file.stride;
+    m_recordCount = (m_data.size() - sizeof(FileHeader)) / m_stride;
+    m_entries = reinterpret_cast<const Entry *>(m_index.data() + sizeof(IndexHeader));
+    m_entryCount = static_cast<std::size_t>(index.count);
+    return true;
+}
+
+void BoardCorpus::close()
+{
+    m_data.close();
+    m_index.close();
+    m_entries = nullptr;
+    m_entryCount = 0;
+    m_stride = 0;
+    m_recordCount = 0;
+}
+
+bool BoardCorpus::range(const Query &query, const Entry **first, const Entry **last) const
+{
+    const bool anyOpening = query.openRow < 0 || query.openCol < 0;
+    if (!isOpen() || query.rows <= 0 || query.cols <= 0 || query.mines < 0 || query.maxBbbv < query.minBbbv
+        || (!anyOpening && query.minBbbv != query.maxBbbv)) {
+        return false;
+    }
+
+    // 匹配项是键区间 [low, high] 内的连续一段
+    const std::uint32_t most = std::numeric_limits<std::uint32_t>::max();
+    const std::uint32_t rows = static_cast<std::uint32_t>(query.rows);
+    const std::uint32_t cols = static_cast<std::uint32_t>(query.cols);
+    const std::uint32_t mines = static_cast<std::uint32_t>(query.mines);
+    const std::uint32_t minBbbv = static_cast<std::uint32_t>(std::max(0, query.minBbbv));
+    const std::uint32_t maxBbbv = static_cast<std::uint32_t>(std::max(0, query.maxBbbv));
+    const std::uint32_t lowRow = anyOpening ? 0 : static_cast<std::uint32_t>(query.openRow);
+    const std::uint32_t lowCol = anyOpening ? 0 : static_cast<std::uint32_t>(query.openCol);
+    const std::uint32_t highRow = anyOpening ? most : lowRow;
+    const std::uint32_t highCol = anyOpening ? most : lowCol;
+    const auto low = std::tie(rows, cols, mines, minBbbv, lowRow, lowCol);
+    const auto high = std::tie(rows, cols, mines, maxBbbv, highRow, highCol);
+
+    const Entry *end = m_entries + m_entryCount;
+    *first = std::lower_bound(m_entries, end, low,
+                              [](const Entry &entry, const decltype(low) &key) { return entry.key() < key; });
+    *last = std::upper_bound(*first, end, high,
+                             [](const decltype(high) &key, const Entry &entry) { return key < entry.key(); });
+    return true;
+}
+
+std::size_t BoardCorpus::count(const Query &query) const
+{
+    const Entry *first = nullptr;
+    const Entry *last = nullptr;
+    return range(query, &first, &last) ? static_cast<std::size_t>(last - first) : 0;
+}
+
+bool BoardCorpus::pick(const Query &query, std::uint64_t random, Board *board) const
+{
+    TRACE_SPAN("BoardCorpus::pick");
+    const Entry *first = nullptr;
+    const Entry *last = nullptr;
+    if (!range(query, &first, &last) || first == last) {
+        return false;
+    }
+    const Entry &entry = first[random % static_cast<std::uint64_t>(last - first)];
+
+    // 只检查选中的这一条：索引可能比数据文件新，或者文件被改坏
+    if (entry.record >= m_recordCount) {
+        return false;
+    }
+    const std::uint8_t *record = m_data.data() + sizeof(FileHeader) + entry.record * m_stride;
+    RecordHeader header;
+    std::memcpy(&header, record, sizeof(RecordHeader));
+    if (header.rows != entry.rows || header.cols != entry.cols || header.mines != entry.mines
+        || static_cast<std::uint64_t>(header.rows) * header.cols > capacityCells(m_stride)
+        || header.openRow >= header.rows || header.openCol >= header.cols) {
+        return false;
+    }
+
+    // 位图必须与记录头一致：地雷数等于置位数，开局区内没有地雷。
+    // load 和调用方都信任这两点，改坏的记录在这里拒绝
+    const std::uint64_t *bits = reinterpret_cast<const std::uint64_t *>(record + sizeof(RecordHeader));
+    const std::uint64_t cells = static_cast<std::uint64_t>(header.rows) * header.cols;
+    if (countMines(bits, cells) != static_cast<long long>(header.mines)) {
+        return false;
+    }
+    for (std::uint32_t r = header.openRow ? header.openRow - 1 : 0; r <= header.openRow + 1 && r < header.rows; ++r) {
+        for (std::uint32_t c = header.openCol ? header.openCol - 1 : 0; c <= header.openCol + 1 && c < header.cols; ++c) {
+            const std::uint64_t index = static_cast<std::uint64_t>(r) * header.cols + c;
+            if (bits[index / 64] >> (index % 64) & 1) {
+                return false;
+            }
+        }
+    }
+
+    board->rows = static_cast<int>(header.rows);
+    board->cols = static_cast<int>(header.cols);
+    board->mines = static_cast<int>(header.mines);
+    board->bbbv = static_cast<int>(header.bbbv);
+    board->openRow = static_cast<int>(header.openRow);
+    board->openCol = static_cast<int>(header.openCol);
+    board->seed = header.seed;
+    board->bits = bits;
+    return true;
+}
+
+void BoardCorpus::load(const Board &board, BoardEngine *engine)
+{
+    TRACE_SPAN("BoardCorpus::load");
+    std::vector<int> mines;
+    mines.reserve(board.mines);
+    const int cells = board.rows * board.cols;
+    for (int base = 0; base < cells; base += 64) {
+        std::uint64_t bits = board.bits[base / 64];
+        for (int index = base; bits && index < cells; ++index, bits >>= 1) {
+            if (bits & 1) {
+                mines.push_back(index);
+            }
+        }
+    }
+    engine->reset(board.rows, board.cols, board.mines);
+    engine->setMineLayout(mines);
+}
+
+bool BoardCorpus::buildIndex(const std::string &path)
+{
+    TRACE_SPAN("BoardCorpus::buildIndex");
+    MappedFile data;
+    FileHeader file;
+    if (!data.open(path) || data.size() < sizeof(FileHeader)) {
+        return false;
+    }
+    std::memcpy(&file, data.data(), sizeof(FileHeader));
+    if (std::memcmp(file.magic, DataMagic, sizeof(DataMagic)) != 0 || file.version != Version
+        || !validStride(file.stride)) {
+        return false;
+    }
+
+    const std::size_t records = (data.size() - sizeof(FileHeader)) / file.stride;
+    if (records > std::numeric_limits<std::uint32_t>::max()) {
+        return false;
+    }
+    std::vector<Entry> entries;
+    std::vector<std::uint64_t> seeds(records);
+    entries.reserve(records);
+    for (std::size_t i = 0; i < records; ++i) {
+        RecordHeader header;
+        std::memcpy(&header, data.data() + sizeof(FileHeader) + i * file.stride, sizeof(RecordHeader));
+        if (header.rows == 0 || header.cols == 0
+            || static_cast<std::uint64_t>(header.rows) * header.cols > capacityCells(file.stride)) {
+            continue;
+        }
+        seeds[i] = header.seed;
+        entries.push_back({header.rows, header.cols, header.mines, header.bbbv, header.openRow, header.openCol,
+                           static_cast<std::uint32_t>(i)});
+    }
+
+    // 键相同的棋盘按种子排列，索引的顺序与写入时的线程调度无关
+    std::sort(entries.begin(), entries.end(), [&](const Entry &a, const Entry &b) {
+        return std::make_tuple(a.key(), seeds[a.record], a.record)
+            < std::make_tuple(b.key(), seeds[b.record], b.record);
+    });
+
+    IndexHeader header;
+    std::memcpy(header.magic, IndexMagic, sizeof(IndexMagic));
+    header.version = Version;
+    header.stride = file.stride;
+    header.reserved = 0;
+    header.count = entries.size();
+
+    const std::string target = indexPath(path);
+    const std::string temporary = target + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(entries.data()),
+                  static_cast<std::streamsize>(entries.size() * sizeof(Entry)));
+        if (!out.flush()) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    // POSIX 上 rename 原子地替换旧索引；Windows 上目标存在时需要先删除
+    if (std::rename(temporary.c_str(), target.c_str()) != 0) {
+        std::remove(target.c_str());
+        if (std::rename(temporary.c_str(), target.c_str()) != 0) {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BoardCorpusWriter::open(const std::string &path, int maxCells)
+{
+    close();
+    m_written = 0;
+
+    std::error_code error;
+    const std::uintmax_t size = std::filesystem::exists(path, error) ? std::filesystem::file_size(path, error) : 0;
+    if (error) {
+        return false;
+    }
+    if (size == 0) {
+        if (maxCells <= 0) {
+            return false;
+        }
+        FileHeader header;
+        std::memcpy(header.magic, DataMagic, sizeof(DataMagic));
+        header.version = BoardCorpus::Version;
+        header.stride = static_cast<std::uint32_t>(strideFor(maxCells));
+        header.reserved = 0;
+        m_out.open(path, std::ios::binary | std::ios::trunc);
+        m_out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        m_stride = header.stride;
+    } else {
+        FileHeader header;
+        std::ifstream in(path, std::ios::binary);
+        if (size < sizeof(FileHeader) || !in.read(reinterpret_cast<char *>(&header), sizeof(header))
+            || std::memcmp(header.magic, DataMagic, sizeof(DataMagic)) != 0
+            || header.version != BoardCorpus::Version || !validStride(header.stride)) {
+            return false;
+        }
+        in.close();
+        // 上次写到一半的记录截掉，新记录从整条记录的边界开始
+        const std::uintmax_t whole = sizeof(FileHeader) + (size - sizeof(FileHeader)) / header.stride * header.stride;
+        if (whole != size) {
+            std::filesystem::resize_file(path, whole, error);
+            if (error) {
+                return false;
+            }
+        }
+        m_out.open(path, std::ios::binary | std::ios::app);
+        m_stride = header.stride;
+    }
+    m_record.assign(m_stride / 8, 0);
+    return static_cast<bool>(m_out);
+}
+
+bool BoardCorpusWriter::close()
+{
+    if (!m_out.is_open()) {
+        return true;
+    }
+    m_out.close();
+    return !m_out.fail();
+}
+
+bool BoardCorpusWriter::append(const BoardEngine &engine, int openRow, int openCol, int bbbv, std::uint64_t seed)
+{
+    if (!m_out.is_open() || !engine.minesPlaced() || !engine.isValidCell(openRow, openCol)
+        || static_cast<std::uint64_t>(engine.cellCount()) > capacityCells(m_stride)) {
+        return false;
+    }
+    for (int r = openRow - 1; r <= openRow + 1; ++r) {
+        for (int c = openCol - 1; c <= openCol + 1; ++c) {
+            if (engine.isValidCell(r, c) && engine.isMine(r, c)) {
+                return false;
+            }
+        }
+    }
+
+    const RecordHeader header = {static_cast<std::uint32_t>(engine.rows()), static_cast<std::uint32_t>(engine.cols()),
+                                 static_cast<std::uint32_t>(engine.mineCount()), static_cast<std::uint32_t>(bbbv),
+                                 static_cast<std::uint32_t>(openRow), static_cast<std::uint32_t>(openCol), seed};
+    std::fill(m_record.begin(), m_record.end(), 0);
+    std::memcpy(m_record.data(), &header, sizeof(header));
+    std::uint64_t *bits = m_record.data() + sizeof(RecordHeader) / 8;
+    const std::vector<std::uint8_t> &cells = engine.cells();
+    for (int index = 0; index < engine.cellCount(); ++index) {
+        if (cells[index] & BoardEngine::MineBit) {
+            bits[index / 64] |= std::uint64_t(1) << (index % 64);
+        }
+    }
+    m_out.write(reinterpret_cast<const char *>(m_record.data()), static_cast<std::streamsize>(m_stride));
+    if (!m_out) {
+        return false;
+    }
+    m_written++;
+    return true;
+}
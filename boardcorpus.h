@@ -0,0 +1,104 @@
+#ifndef BOARDCORPUS_H
+#define BOARDCORPUS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "boardengine.h"
+#include "mappedfile.h"
+
+// 预生成的棋盘库。数据文件只追加：定长头部之后是等长的记录，
+// 每条记录是记录头（尺寸、地雷数、3BV、开局位置、来源种子）加上
+// 按单元格下标排列的地雷位图。旁边的 .idx 文件是按
+// (行, 列, 地雷数, 3BV, 开局位置) 排序的索引，追加完成后由 buildIndex 重建。
+// 两个文件都只读映射，打开时不做解析，按条件随机取一块是索引上的两次二分查找。
+// 整数按本机字节序（小端）存储
+class BoardCorpus
+{
+public:
+    static const std::uint32_t Version = 1;
+
+    // 一块棋盘，bits 指向映射中的地雷位图，在 close() 之前有效
+    struct Board {
+        int rows = 0;
+        int cols = 0;
+        int mines = 0;
+        int bbbv = 0;
+        int openRow = 0; // 开局点击位置，周围3x3内没有地雷
+        int openCol = 0;
+        std::uint64_t seed = 0;
+        const std::uint64_t *bits = nullptr;
+    };
+
+    // 查询条件：尺寸和地雷数必须相同，3BV 在 [minBbbv, maxBbbv] 内。
+    // 指定开局位置时 3BV 必须是单一值，这样匹配项在索引中仍是连续的一段
+    struct Query {
+        int rows = 0;
+        int cols = 0;
+        int mines = 0;
+        int minBbbv = 0;
+        int maxBbbv = INT32_MAX;
+        int openRow = -1; // -1 表示任意位置
+        int openCol = -1;
+    };
+
+    BoardCorpus() = default;
+
+    // 映射 path 和 indexPath(path)；索引之后追加的棋盘在重建索引前不可见
+    bool open(const std::string &path);
+    void close();
+    bool isOpen() const { return m_index.isOpen(); }
+
+    // 已索引的棋盘数和满足条件的棋盘数
+    std::size_t boardCount() const { return m_entryCount; }
+    std::size_t count(const Query &query) const;
+
+    // 用 random 在满足条件的棋盘中均匀地选一块，没有时返回 false。
+    // 选中的记录与位图不一致（地雷数不符或开局区有雷）时也返回 false
+    bool pick(const Query &query, std::uint64_t random, Board *board) const;
+
+    // 把棋盘的地雷布局放进引擎
+    static void load(const Board &board, BoardEngine *engine);
+
+    // 按数据文件重建排序索引：先写临时文件再替换，已映射旧索引的进程不受影响
+    static bool buildIndex(const std::string &path);
+    static std::string indexPath(const std::string &path) { return path + ".idx"; }
+
+private:
+    struct Entry;
+
+    MappedFile m_data;
+    MappedFile m_index;
+    const Entry *m_entries = nullptr;
+    std::size_t m_entryCount = 0;
+    std::size_t m_stride = 0;
+    std::size_t m_recordCount = 0;
+
+    bool range(const Query &query, const Entry **first, const Entry **last) const;
+};
+
+// 向棋盘库追加棋盘。新文件的记录长度按 maxCells 确定，
+// 已有文件沿用其记录长度，放不下的棋盘被拒绝。写入经过缓冲，close() 时落盘
+class BoardCorpusWriter
+{
+public:
+    BoardCorpusWriter() = default;
+    ~BoardCorpusWriter() { close(); }
+
+    bool open(const std::string &path, int maxCells);
+    bool close();
+
+    // engine 必须已布雷，(openRow, openCol) 周围3x3内没有地雷
+    bool append(const BoardEngine &engine, int openRow, int openCol, int bbbv, std::uint64_t seed);
+    long long written() const { return m_written; }
+
+private:
+    std::ofstream m_out;
+    std::size_t m_stride = 0;
+    long long m_written = 0;
+    std::vector<std::uint64_t> m_record; // 复用的记录缓冲区
+};
+
+#endif // BOARDCORPUS_H
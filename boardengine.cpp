@@ -0,0 +1,603 @@
+#include "boardengine.h"
+#include "rng.h"
+#include "adjacency.h"
+#include "trace.h"
+#include <algorithm>
+#include <limits>
+
+void BoardEngine::reset(int rows, int cols, int mineCount)
+{
+    const int oldMineCount = m_mineCount;
+    const int oldHiddenSafe = m_hiddenSafeCells;
+    const int oldFlagged = m_flaggedCount;
+
+    m_rows = rows;
+    m_cols = cols;
+    m_mineCount = mineCount;
+    m_flaggedCount = 0;
+    m_hiddenSafeCells = rows * cols - mineCount;
+    m_minesPlaced = false;
+    m_gameOver = false;
+    m_gameWon = false;
+
+    m_cells.assign(static_cast<size_t>(rows) * cols, 0);
+    m_wordsPerRow = Adjacency::wordsPerRow(cols);
+    m_minePlanes.assign(static_cast<size_t>(rows) * m_wordsPerRow, 0);
+    m_changedCells.clear();
+    m_changedCells.reserve(m_cells.size());
+    m_revealHead = 0;
+    m_revealPending = false;
+    m_journaling = false;
+    m_journal.clear();
+
+    // 旧的变更记录已失去意义，观察者需要整体刷新
+    m_changes.cells.clear();
+    m_changeBits.assign((m_cells.size() + 63) / 64, 0);
+    m_changeSlotsValid = false;
+    m_changes.flaggedDelta -= oldFlagged;
+    markFullUpdate(oldMineCount, oldHiddenSafe);
+}
+
+void BoardEngine::placeMines(int firstRow, int firstCol)
+{
+    placeMines(firstRow, firstCol, threadLocalRandom());
+}
+
+void BoardEngine::placeMines(int firstRow, int firstCol, std::uint64_t seed)
+{
+    TRACE_SPAN("BoardEngine::placeMines");
+    const int oldMineCount = m_mineCount;
+    const int oldHiddenSafe = m_hiddenSafeCells;
+    m_seed = seed;
+
+    // 第一次点击位置周围的3x3安全区域，按下标升序排列
+    int safeCells[9];
+    int safeCount = 0;
+    for (int r = firstRow - 1; r <= firstRow + 1; ++r) {
+        for (int c = firstCol - 1; c <= firstCol + 1; ++c) {
+            if (isValidCell(r, c)) {
+                safeCells[safeCount++] = indexOf(r, c);
+            }
+        }
+    }
+
+    // 候选单元格为安全区以外的所有单元格，地雷不能超过候选数量
+    const int candidates = cellCount() - safeCount;
+    const int mines = std::min(m_mineCount, candidates);
+
+    // 稀疏部分 Fisher-Yates：只记录被交换过的位置，未出现的位置 k 映射到自身
+    int capacity = 16;
+    while (capacity < mines * 2) {
+        capacity <<= 1;
+    }
+    const int mask = capacity - 1;
+    m_swapKeys.assign(capacity, -1);
+    m_swapValues.resize(capacity);
+
+    auto slotOf = [&](int key) {
+        int slot = static_cast<int>((static_cast<std::uint64_t>(key) * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+        while (m_swapKeys[slot] != -1 && m_swapKeys[slot] != key) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    };
+    auto valueAt = [&](int key) {
+        const int slot = slotOf(key);
+        return m_swapKeys[slot] == -1 ? key : m_swapValues[slot];
+    };
+    auto store = [&](int key, int value) {
+        const int slot = slotOf(key);
+        m_swapKeys[slot] = key;
+        m_swapValues[slot] = value;
+    };
+
+    Xoshiro256 rng(seed);
+    for (int i = 0; i < mines; ++i) {
+        const int j = i + static_cast<int>(rng.bounded(static_cast<std::uint32_t>(candidates - i)));
+        const int picked = valueAt(j);
+        store(j, valueAt(i));
+
+        // 把候选序号映射为跳过安全区后的单元格下标
+        int index = picked;
+        for (int k = 0; k < safeCount && safeCells[k] <= index; ++k) {
+            ++index;
+        }
+        setMineBit(index);
+    }
+    m_mineCount = mines;
+    m_hiddenSafeCells = cellCount() - m_mineCount;
+    m_minesPlaced = true;
+
+    // 计算每个单元格周围的地雷数量
+    calculateAdjacentMines();
+    markFullUpdate(oldMineCount, oldHiddenSafe);
+}
+
+void BoardEngine::setMineLayout(const std::vector<int> &mineIndices)
+{
+    TRACE_SPAN("BoardEngine::setMineLayout");
+    const int oldMineCount = m_mineCount;
+    const int oldHiddenSafe = m_hiddenSafeCells;
+    for (std::uint8_t &cell : m_cells) {
+        cell &= ~MineBit;
+    }
+    std::fill(m_minePlanes.begin(), m_minePlanes.end(), 0);
+    for (int index : mineIndices) {
+        setMineBit(index);
+    }
+    m_mineCount = static_cast<int>(mineIndices.size());
+    m_hiddenSafeCells = cellCount() - m_mineCount;
+    m_minesPlaced = true;
+
+    calculateAdjacentMines();
+    markFullUpdate(oldMineCount, oldHiddenSafe);
+}
+
+void BoardEngine::packVisible(std::uint64_t *out) const
+{
+    const int count = cellCount();
+    for (int base = 0; base < count; base += 32) {
+        const int end = std::min(base + 32, count);
+        std::uint64_t word = 0;
+        for (int i = base; i < end; ++i) {
+            const std::uint8_t cell = m_cells[i];
+            const std::uint64_t state = ((cell & RevealedBit) ? Shown : Hidden)
+                                        | ((cell & FlaggedBit) ? Flagged : Hidden);
+            word |= state << (2 * (i - base));
+        }
+        out[base / 32] = word;
+    }
+}
+
+bool BoardEngine::restore(int rows, int cols, int mineCount, bool minesPlaced,
+                          const std::uint64_t *minePlanes, const std::uint64_t *visible)
+{
+    TRACE_SPAN("BoardEngine::restore");
+    reset(rows, cols, mineCount);
+    const int oldMineCount = m_mineCount;
+    const int oldHiddenSafe = m_hiddenSafeCells;
+
+    if (minesPlaced) {
+        // 行末超出列数的填充位必须为0，计数内核依赖这一点
+        const int tailBits = cols % 64;
+        const std::uint64_t tailMask = tailBits ? (std::uint64_t(1) << tailBits) - 1 : ~std::uint64_t(0);
+        int mines = 0;
+        for (int row = 0; row < rows; ++row) {
+            const std::uint64_t *planes = minePlanes + static_cast<size_t>(row) * m_wordsPerRow;
+            if (planes[m_wordsPerRow - 1] & ~tailMask) {
+                reset(rows, cols, mineCount);
+                return false;
+            }
+            std::copy(planes, planes + m_wordsPerRow,
+                      m_minePlanes.begin() + static_cast<size_t>(row) * m_wordsPerRow);
+            std::uint8_t *cells = &m_cells[indexOf(row, 0)];
+            for (int w = 0; w < m_wordsPerRow; ++w) {
+                std::uint64_t bits = planes[w];
+                for (int bit = 0; bits; ++bit, bits >>= 1) {
+                    if (bits & 1) {
+                        cells[w * 64 + bit] |= MineBit;
+                        ++mines;
+                    }
+                }
+            }
+        }
+        m_mineCount = mines;
+        m_hiddenSafeCells = cellCount() - mines;
+        m_minesPlaced = true;
+        calculateAdjacentMines();
+    }
+
+    // 解包可见状态，同时推出标记数、剩余安全格和是否踩雷
+    bool lost = false;
+    const int count = cellCount();
+    for (int base = 0; base < count; base += 32) {
+        const int end = std::min(base + 32, count);
+        std::uint64_t word = visible[base / 32];
+        for (int i = base; word; ++i, word >>= 2) {
+            if (i >= end) {
+                reset(rows, cols, mineCount);
+                return false;
+            }
+            const std::uint64_t state = word & 3;
+            if (state & Flagged) {
+                m_cells[i] |= FlaggedBit;
+                ++m_flaggedCount;
+            }
+            if (!(state & Shown)) {
+                continue;
+            }
+            // 布雷之前不可能揭开任何格子，揭开的格子只有地雷可能同时带旗
+            if (!minesPlaced || (state == ShownFlagged && !(m_cells[i] & MineBit))) {
+                reset(rows, cols, mineCount);
+                return false;
+            }
+            m_cells[i] |= RevealedBit;
+            if (m_cells[i] & MineBit) {
+                lost = true;
+            } else {
+                --m_hiddenSafeCells;
+            }
+        }
+    }
+
+    m_changes.flaggedDelta += m_flaggedCount;
+    markFullUpdate(oldMineCount, oldHiddenSafe);
+    if (lost) {
+        m_gameOver = true;
+        m_changes.gameEnded = true;
+    } else if (m_minesPlaced) {
+        checkGameWon();
+    }
+    return true;
+}
+
+void BoardEngine::calculateAdjacentMines()
+{
+    TRACE_SPAN("BoardEngine::calculateAdjacentMines");
+    Adjacency::computeCounts(m_minePlanes.data(), m_wordsPerRow, m_rows, m_cols, m_cells.data());
+}
+
+void BoardEngine::setMineBit(int index)
+{
+    m_cells[index] |= MineBit;
+    const int row = index / m_cols;
+    const int col = index % m_cols;
+    m_minePlanes[static_cast<size_t>(row) * m_wordsPerRow + col / 64] |= std::uint64_t(1) << (col % 64);
+}
+
+void BoardEngine::setMine(int row, int col, bool mine)
+{
+    if (!isValidCell(row, col) || isMine(row, col) == mine) {
+        return;
+    }
+
+    const int index = indexOf(row, col);
+    std::uint64_t &word = m_minePlanes[static_cast<size_t>(row) * m_wordsPerRow + col / 64];
+    const std::uint64_t bit = std::uint64_t(1) << (col % 64);
+    int ownCount = 0;
+
+    // 调整周围8个非地雷单元格的计数，同时统计自身周围的地雷
+    for (int r = row - 1; r <= row + 1; ++r) {
+        for (int c = col - 1; c <= col + 1; ++c) {
+            if ((r == row && c == col) || !isValidCell(r, c)) {
+                continue;
+            }
+            std::uint8_t &neighbour = m_cells[indexOf(r, c)];
+            if (neighbour & MineBit) {
+                ownCount++;
+            } else {
+                const std::uint8_t oldState = neighbour;
+                neighbour = static_cast<std::uint8_t>(mine ? neighbour + 1 : neighbour - 1);
+                recordChange(indexOf(r, c), oldState);
+            }
+        }
+    }
+
+    std::uint8_t &cell = m_cells[index];
+    const std::uint8_t oldState = cell;
+    const int delta = mine ? 1 : -1;
+    if (mine) {
+        word |= bit;
+        cell = static_cast<std::uint8_t>((cell & ~CountMask) | MineBit);
+    } else {
+        word &= ~bit;
+        cell = static_cast<std::uint8_t>((cell & ~(CountMask | MineBit)) | ownCount);
+    }
+    recordChange(index, oldState);
+    m_mineCount += delta;
+    m_hiddenSafeCells -= delta;
+    m_changes.mineCountDelta += delta;
+    m_changes.hiddenSafeDelta -= delta;
+}
+
+void BoardEngine::moveMine(int fromRow, int fromCol, int toRow, int toCol)
+{
+    if (!isValidCell(fromRow, fromCol) || !isValidCell(toRow, toCol)
+        || !isMine(fromRow, fromCol) || isMine(toRow, toCol)) {
+        return;
+    }
+    setMine(fromRow, fromCol, false);
+    setMine(toRow, toCol, true);
+}
+
+const std::vector<int> &BoardEngine::revealCell(int row, int col)
+{
+    beginReveal(row, col);
+    finishReveal();
+    return m_changedCells;
+}
+
+bool BoardEngine::beginReveal(int row, int col)
+{
+    finishReveal();
+    m_changedCells.clear();
+    m_revealHead = 0;
+
+    if (m_gameOver || !isValidCell(row, col)) {
+        return false;
+    }
+
+    const int start = indexOf(row, col);
+    std::uint8_t &cell = m_cells[start];
+
+    // 如果单元格已揭示或已标记，则不做任何操作
+    if (cell & (RevealedBit | FlaggedBit)) {
+        return false;
+    }
+
+    // 如果是地雷，显示所有地雷并结束游戏
+    if (cell & MineBit) {
+        revealMines();
+        return false;
+    }
+
+    revealSafeCell(start);
+    m_revealPending = true;
+    return true;
+}
+
+const std::vector<int> &BoardEngine::chordCell(int row, int col)
+{
+    beginChord(row, col);
+    finishReveal();
+    return m_changedCells;
+}
+
+bool BoardEngine::beginChord(int row, int col)
+{
+    finishReveal();
+    m_changedCells.clear();
+    m_revealHead = 0;
+
+    if (m_gameOver || !isValidCell(row, col)) {
+        return false;
+    }
+    const std::uint8_t cell = cellAt(row, col);
+    if (!(cell & RevealedBit) || !(cell & CountMask)) {
+        return false;
+    }
+
+    const int r0 = row > 0 ? row - 1 : row;
+    const int r1 = row < m_rows - 1 ? row + 1 : row;
+    const int c0 = col > 0 ? col - 1 : col;
+    const int c1 = col < m_cols - 1 ? col + 1 : col;
+    int flags = 0;
+    bool hitMine = false;
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            const std::uint8_t state = m_cells[indexOf(r, c)];
+            flags += (state & FlaggedBit) ? 1 : 0;
+            hitMine |= (state & (MineBit | RevealedBit | FlaggedBit)) == MineBit;
+        }
+    }
+    if (flags != (cell & CountMask)) {
+        return false;
+    }
+    if (hitMine) {
+        revealMines();
+        return false;
+    }
+
+    // 周围的每个未知格都作为展开起点入队
+    for (int r = r0; r <= r1; ++r) {
+        for (int c = c0; c <= c1; ++c) {
+            if (!(m_cells[indexOf(r, c)] & (RevealedBit | FlaggedBit))) {
+                revealSafeCell(indexOf(r, c));
+            }
+        }
+    }
+    if (m_changedCells.empty()) {
+        return false;
+    }
+    m_revealPending = true;
+    return true;
+}
+
+bool BoardEngine::continueReveal(int maxExpansions)
+{
+    if (!m_revealPending) {
+        return true;
+    }
+    TRACE_SPAN("BoardEngine::continueReveal");
+
+    // 广度优先展开空白区域：m_changedCells 本身就是工作队列，
+    // 单元格入队时即被标记为已揭开，因此每个单元格最多处理一次
+    for (int processed = 0; m_revealHead < m_changedCells.size() && processed < maxExpansions;
+         ++processed) {
+        const int index = m_changedCells[m_revealHead++];
+        if (m_cells[index] & CountMask) {
+            continue;
+        }
+
+        const int r = index / m_cols;
+        const int c = index % m_cols;
+        const int r0 = r > 0 ? r - 1 : r;
+        const int r1 = r < m_rows - 1 ? r + 1 : r;
+        const int c0 = c > 0 ? c - 1 : c;
+        const int c1 = c < m_cols - 1 ? c + 1 : c;
+        for (int nr = r0; nr <= r1; ++nr) {
+            for (int nc = c0; nc <= c1; ++nc) {
+                const int neighbour = nr * m_cols + nc;
+                std::uint8_t &state = m_cells[neighbour];
+                // 空白格周围不会有地雷，只需跳过已揭开或已标记的单元格
+                if (state & (RevealedBit | FlaggedBit)) {
+                    continue;
+                }
+                revealSafeCell(neighbour);
+            }
+        }
+    }
+
+    if (m_revealHead < m_changedCells.size()) {
+        return false;
+    }
+
+    m_revealPending = false;
+    checkGameWon();
+    return true;
+}
+
+void BoardEngine::finishReveal()
+{
+    continueReveal(std::numeric_limits<int>::max());
+}
+
+void BoardEngine::revealMines()
+{
+    for (int i = 0; i < cellCount(); ++i) {
+        if ((m_cells[i] & (MineBit | RevealedBit)) == MineBit) {
+            const std::uint8_t oldState = m_cells[i];
+            m_cells[i] |= RevealedBit;
+            m_changedCells.push_back(i);
+            recordChange(i, oldState);
+        }
+    }
+    m_gameOver = true;
+    m_changes.gameEnded = true;
+}
+
+void BoardEngine::revealSafeCell(int index)
+{
+    const std::uint8_t oldState = m_cells[index];
+    m_cells[index] |= RevealedBit;
+    m_changedCells.push_back(index);
+    recordChange(index, oldState);
+    --m_hiddenSafeCells;
+    --m_changes.hiddenSafeDelta;
+}
+
+bool BoardEngine::toggleFlag(int row, int col)
+{
+    finishReveal();
+    if (m_gameOver || !isValidCell(row, col)) {
+        return false;
+    }
+
+    std::uint8_t &cell = m_cells[indexOf(row, col)];
+    if (cell & RevealedBit) {
+        return false;
+    }
+
+    const std::uint8_t oldState = cell;
+    m_changedCells.clear();
+    m_changedCells.push_back(indexOf(row, col));
+    cell ^= FlaggedBit;
+    recordChange(indexOf(row, col), oldState);
+    const int delta = (cell & FlaggedBit) ? 1 : -1;
+    m_flaggedCount += delta;
+    m_changes.flaggedDelta += delta;
+    return true;
+}
+
+void BoardEngine::beginJournal()
+{
+    // 不按整盘预留：日志随这一步的变化量成倍增长，均摊常数时间，
+    // 占用不超过历史上最大的一步（每次变化4字节）；容量在各步之间保留
+    m_journal.clear();
+    m_journaling = true;
+}
+
+void BoardEngine::setVisibleState(int index, VisibleState state)
+{
+    const std::uint8_t oldState = m_cells[index];
+    const std::uint8_t newState = (oldState & ~(RevealedBit | FlaggedBit))
+                                  | ((state & Shown) ? RevealedBit : 0) | ((state & Flagged) ? FlaggedBit : 0);
+    if (newState != oldState) {
+        m_cells[index] = newState;
+        recordChange(index, oldState);
+    }
+}
+
+void BoardEngine::restoreCounters(int flaggedDelta, int hiddenSafeDelta, bool gameOver, bool gameWon)
+{
+    m_flaggedCount += flaggedDelta;
+    m_changes.flaggedDelta += flaggedDelta;
+    m_hiddenSafeCells += hiddenSafeDelta;
+    m_changes.hiddenSafeDelta += hiddenSafeDelta;
+    if (gameOver && !m_gameOver) {
+        m_changes.gameEnded = true;
+    }
+    m_gameOver = gameOver;
+    m_gameWon = gameWon;
+}
+
+void BoardEngine::checkGameWon()
+{
+    // 所有非地雷单元格都已揭示才算胜利，计数器使判断为常数时间
+    if (m_gameOver || m_hiddenSafeCells > 0) {
+        return;
+    }
+
+    // 所有非地雷单元格都已揭示，游戏胜利，标记所有地雷
+    m_gameOver = true;
+    m_gameWon = true;
+    m_changes.gameEnded = true;
+    for (int i = 0; i < cellCount(); ++i) {
+        if ((m_cells[i] & (MineBit | FlaggedBit)) == MineBit) {
+            const std::uint8_t oldState = m_cells[i];
+            m_cells[i] |= FlaggedBit;
+            m_changedCells.push_back(i);
+            recordChange(i, oldState);
+            m_flaggedCount++;
+            m_changes.flaggedDelta++;
+        }
+    }
+}
+
+void BoardEngine::recordChange(int index, std::uint8_t oldState)
+{
+    if (m_journaling) {
+        m_journal.push_back(static_cast<std::uint32_t>(index) << 2
+                            | ((oldState & RevealedBit) ? Shown : Hidden)
+                            | ((oldState & FlaggedBit) ? Flagged : Hidden));
+    }
+    std::uint64_t &word = m_changeBits[index / 64];
+    const std::uint64_t bit = std::uint64_t(1) << (index % 64);
+    if (!(word & bit)) {
+        word |= bit;
+        if (m_changeSlotsValid) {
+            m_changeSlots[index] = static_cast<int>(m_changes.cells.size());
+        }
+        m_changes.cells.push_back({index, oldState, m_cells[index]});
+        return;
+    }
+
+    // 同一轮内再次变化（例如标记后又取消），只更新新状态。
+    // 重复变化一般来自少量的标记和布雷操作，最近的记录通常就在末尾
+    if (!m_changeSlotsValid) {
+        const std::size_t window = std::min<std::size_t>(m_changes.cells.size(), 64);
+        for (std::size_t i = m_changes.cells.size(); i > m_changes.cells.size() - window; --i) {
+            if (m_changes.cells[i - 1].index == index) {
+                m_changes.cells[i - 1].newState = m_cells[index];
+                return;
+            }
+        }
+        m_changeSlots.resize(m_cells.size());
+        for (std::size_t i = 0; i < m_changes.cells.size(); ++i) {
+            m_changeSlots[m_changes.cells[i].index] = static_cast<int>(i);
+        }
+        m_changeSlotsValid = true;
+    }
+    m_changes.cells[m_changeSlots[index]].newState = m_cells[index];
+}
+
+void BoardEngine::markFullUpdate(int oldMineCount, int oldHiddenSafe)
+{
+    m_changes.mineCountDelta += m_mineCount - oldMineCount;
+    m_changes.hiddenSafeDelta += m_hiddenSafeCells - oldHiddenSafe;
+    m_changes.fullUpdate = true;
+}
+
+void BoardEngine::clearChanges()
+{
+    for (const CellChange &change : m_changes.cells) {
+        m_changeBits[change.index / 64] = 0;
+    }
+    m_changes.cells.clear();
+    m_changeSlotsValid = false;
+    m_changes.flaggedDelta = 0;
+    m_changes.mineCountDelta = 0;
+    m_changes.hiddenSafeDelta = 0;
+    m_changes.gameEnded = false;
+    m_changes.fullUpdate = false;
+}
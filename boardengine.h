@@ -0,0 +1,207 @@
+#ifndef BOARDENGINE_H
+#define BOARDENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 无界面的扫雷引擎：所有状态保存在一块连续的字节数组中，
+// 每个单元格一个字节，低4位为相邻地雷数，高位为状态标志。
+// 不依赖 QApplication，可以单独运行、测试和剖析。
+class BoardEngine
+{
+public:
+    enum CellBits : std::uint8_t {
+        CountMask   = 0x0F,  // 相邻地雷数量 (0-8)
+        MineBit     = 0x10,  // 是否是地雷
+        RevealedBit = 0x20,  // 是否已揭开
+        FlaggedBit  = 0x40   // 是否已标记
+    };
+
+    // 一个单元格的状态变化（同一轮内多次变化时合并为最早的旧状态和最新的新状态）
+    struct CellChange {
+        int index;
+        std::uint8_t oldState;
+        std::uint8_t newState;
+    };
+
+    // 变更集：自上次 clearChanges() 以来所有变化的单元格和计数器增量，
+    // 观察者据此只更新变化的部分。重置、布雷这类逐格记录代价过高的操作
+    // 只设置 fullUpdate，观察者应整体刷新
+    struct ChangeSet {
+        std::vector<CellChange> cells;
+        int flaggedDelta = 0;
+        int mineCountDelta = 0;
+        int hiddenSafeDelta = 0;
+        bool gameEnded = false;
+        bool fullUpdate = false;
+
+        bool empty() const
+        {
+            return cells.empty() && !flaggedDelta && !mineCountDelta && !hiddenSafeDelta
+                && !gameEnded && !fullUpdate;
+        }
+    };
+
+    BoardEngine() = default;
+
+    // 重置为新的空白游戏板，容量足够时不重新分配内存
+    void reset(int rows, int cols, int mineCount);
+
+    // 游戏参数
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+    int cellCount() const { return m_rows * m_cols; }
+    int mineCount() const { return m_mineCount; }
+    int flaggedCount() const { return m_flaggedCount; }
+    int remainingMines() const { return m_mineCount - m_flaggedCount; }
+    int hiddenSafeCells() const { return m_hiddenSafeCells; }
+
+    // 游戏状态
+    bool minesPlaced() const { return m_minesPlaced; }
+    bool isGameOver() const { return m_gameOver; }
+    bool isGameWon() const { return m_gameWon; }
+
+    // 单元格查询
+    bool isValidCell(int row, int col) const
+    {
+        return row >= 0 && row < m_rows && col >= 0 && col < m_cols;
+    }
+    int indexOf(int row, int col) const { return row * m_cols + col; }
+    std::uint8_t cellAt(int row, int col) const { return m_cells[indexOf(row, col)]; }
+    bool isMine(int row, int col) const { return cellAt(row, col) & MineBit; }
+    bool isRevealed(int row, int col) const { return cellAt(row, col) & RevealedBit; }
+    bool isFlagged(int row, int col) const { return cellAt(row, col) & FlaggedBit; }
+    int adjacentMines(int row, int col) const { return cellAt(row, col) & CountMask; }
+    const std::vector<std::uint8_t> &cells() const { return m_cells; }
+
+    // 放置地雷，保证第一次点击的位置及其周围没有地雷。
+    // 对安全区外的单元格做稀疏的部分 Fisher-Yates 洗牌，耗时为 O(地雷数)；
+    // 相同的种子、尺寸和首次点击位置总是得到相同的棋盘。
+    // 首次点击位置及其周围都在棋盘外时（例如 (-2, -2)）没有安全区，在全盘均匀布雷
+    void placeMines(int firstRow, int firstCol, std::uint64_t seed);
+    void placeMines(int firstRow, int firstCol);
+    std::uint64_t seed() const { return m_seed; }
+
+    // 按给定的单元格下标放置地雷（用于复现棋盘），数量即为新的地雷总数
+    void setMineLayout(const std::vector<int> &mineIndices);
+
+    // 每格2位的可见状态，按单元格下标每个64位字存32格（存档格式）。
+    // 踩雷后插过旗的地雷也会被揭开，这时两位都置位
+    enum VisibleState : std::uint8_t {
+        Hidden       = 0,
+        Shown        = 1,
+        Flagged      = 2,
+        ShownFlagged = 3
+    };
+    static std::size_t visibleWords(int cellCount) { return (static_cast<std::size_t>(cellCount) + 31) / 32; }
+    void packVisible(std::uint64_t *out) const;
+
+    // 从存档恢复整盘状态：地雷行位平面（rows * wordsPerRow 个字，minesPlaced 为 false 时忽略）
+    // 和 packVisible 的输出。相邻计数重新计算，标记数、剩余安全格和胜负由状态推出。
+    // 数据不合法时返回 false，引擎停留在空白棋盘
+    bool restore(int rows, int cols, int mineCount, bool minesPlaced,
+                 const std::uint64_t *minePlanes, const std::uint64_t *visible);
+
+    // 计算每个单元格周围的地雷数量（位平面向量化内核，见 adjacency.h）
+    void calculateAdjacentMines();
+
+    // 增量修改单个地雷，只调整它周围8个单元格的计数，地雷总数随之变化。
+    // 用于开局前的调整（例如把首次点击处的地雷移走）
+    void setMine(int row, int col, bool mine);
+    void moveMine(int fromRow, int fromCol, int toRow, int toCol);
+
+    // 地雷布局的行位平面
+    const std::vector<std::uint64_t> &minePlanes() const { return m_minePlanes; }
+    int wordsPerRow() const { return m_wordsPerRow; }
+
+    // 揭示单元格，空白区域用迭代的方式展开，踩雷或揭开全部安全格时结束游戏。
+    // 返回本次状态发生变化的单元格下标，供视图只重绘这些单元格；
+    // 返回的引用在下一次修改引擎之前有效
+    const std::vector<int> &revealCell(int row, int col);
+
+    // 分步揭示：beginReveal 揭开起点，之后反复调用 continueReveal，
+    // 每次最多展开 maxExpansions 个排队的单元格，全部完成时返回 true。
+    // 新揭开的单元格依次追加到 changedCells()，最终状态与一次性揭示完全相同
+    bool beginReveal(int row, int col);
+    bool continueReveal(int maxExpansions);
+    void finishReveal();
+    bool isRevealPending() const { return m_revealPending; }
+    int pendingRevealCells() const { return static_cast<int>(m_changedCells.size() - m_revealHead); }
+
+    // 和弦：已揭开的数字格周围的标记数等于数字时，揭开周围其余未标记的单元格，
+    // 标记有误时踩雷结束游戏。beginChord 与 beginReveal 一样只揭开起点，
+    // 之后由 continueReveal / finishReveal 完成展开
+    bool beginChord(int row, int col);
+    const std::vector<int> &chordCell(int row, int col);
+
+    // 切换标记状态，返回是否发生了变化。
+    // 进行中的分步揭示会先被完成，需要重绘的调用方应先调用 finishReveal()
+    bool toggleFlag(int row, int col);
+
+    // 操作日志（用于撤销）：beginJournal 之后每次单元格变化都按发生顺序记下
+    // 下标和变化前的可见状态，直到 endJournal；reset 时自动停止。
+    // 同一单元格在一步内变化多次时会出现多次，第一次的旧状态才是这一步之前的状态。
+    // 每项4字节：(下标 << 2) | 旧的 VisibleState，单元格数不超过 2^30
+    void beginJournal();
+    void endJournal() { m_journaling = false; }
+    const std::vector<std::uint32_t> &journal() const { return m_journal; }
+    static int journalIndex(std::uint32_t entry) { return static_cast<int>(entry >> 2); }
+    static VisibleState journalOldState(std::uint32_t entry) { return static_cast<VisibleState>(entry & 3); }
+
+    // 撤销/重做：直接改写单元格的可见状态并记入变更集，不展开、不判断胜负，
+    // 也不更新计数器；计数器和游戏状态随后由 restoreCounters 按记录的增量恢复
+    void setVisibleState(int index, VisibleState state);
+    void restoreCounters(int flaggedDelta, int hiddenSafeDelta, bool gameOver, bool gameWon);
+
+    // 最近一次操作中状态发生变化的单元格下标
+    const std::vector<int> &changedCells() const { return m_changedCells; }
+
+    // 累积的变更集，跨多次操作合并，直到调用 clearChanges()
+    const ChangeSet &changes() const { return m_changes; }
+    void clearChanges();
+
+private:
+    int m_rows = 0;
+    int m_cols = 0;
+    int m_mineCount = 0;
+    int m_flaggedCount = 0;
+    int m_hiddenSafeCells = 0; // 尚未揭开的非地雷单元格，归零即胜利
+    bool m_minesPlaced = false;
+    bool m_gameOver = false;
+    bool m_gameWon = false;
+
+    std::vector<std::uint8_t> m_cells;
+    std::vector<std::uint64_t> m_minePlanes;
+    int m_wordsPerRow = 0;
+    std::vector<int> m_changedCells; // 预留 cellCount 容量，展开时不再分配
+    std::size_t m_revealHead = 0;        // 展开队列中下一个待处理的位置
+    bool m_revealPending = false;
+    std::uint64_t m_seed = 0;
+
+    // 撤销用的操作日志
+    bool m_journaling = false;
+    std::vector<std::uint32_t> m_journal;
+
+    // 变更集和其中已记录单元格的位图（每格一位，用于合并重复变化）
+    ChangeSet m_changes;
+    std::vector<std::uint64_t> m_changeBits;
+
+    // 单元格在变更集中的位置。撤销大面积展开时几乎每格都会重复变化，
+    // 从末尾查找退化为平方复杂度，这时才建立，变更集清空前一直有效
+    std::vector<int> m_changeSlots;
+    bool m_changeSlotsValid = false;
+
+    // 稀疏洗牌用的开放寻址哈希表，跨局复用
+    std::vector<int> m_swapKeys;
+    std::vector<int> m_swapValues;
+
+    void setMineBit(int index);
+    void recordChange(int index, std::uint8_t oldState);
+    void markFullUpdate(int oldMineCount, int oldHiddenSafe);
+    void revealSafeCell(int index);
+    void revealMines();
+    void checkGameWon();
+};
+
+#endif // BOARDENGINE_H
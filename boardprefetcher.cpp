@@ -0,0 +1,226 @@
+#include "boardprefetcher.h"
+#include "rng.h"
+#include "trace.h"
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// 把棋盘调整为首次点击 (firstRow, firstCol) 下的布局：点击处3x3内没有地雷，
+// 地雷数为 placeMines 对这次点击钳制后的 min(mines, 安全区外的格子数)。
+// 池中的棋盘在全盘均匀布雷，给定开局区内的雷数时，区外的地雷是区外格子的均匀子集；
+// 移走区内的地雷后在区外随机空格补上、或随机去掉多出的地雷，结果仍是区外的均匀布局，
+// 与直接用 placeMines 生成的分布相同
+void clearOpening(BoardEngine &board, int firstRow, int firstCol, int mines, std::uint64_t seed)
+{
+    const int rows = board.rows();
+    const int cols = board.cols();
+    auto inOpening = [&](int index) {
+        const int r = index / cols;
+        const int c = index % cols;
+        return r >= firstRow - 1 && r <= firstRow + 1 && c >= firstCol - 1 && c <= firstCol + 1;
+    };
+
+    int safeCount = 0;
+    for (int r = firstRow - 1; r <= firstRow + 1; ++r) {
+        for (int c = firstCol - 1; c <= firstCol + 1; ++c) {
+            if (!board.isValidCell(r, c)) {
+                continue;
+            }
+            ++safeCount;
+            if (board.isMine(r, c)) {
+                board.setMine(r, c, false);
+            }
+        }
+    }
+    const int target = std::min(mines, rows * cols - safeCount);
+
+    // 目标数不超过区外的格子数，补雷时总能找到空位
+    Xoshiro256 rng(seed);
+    auto randomCell = [&] {
+        return static_cast<int>(rng.bounded(static_cast<std::uint32_t>(rows * cols)));
+    };
+    while (board.mineCount() < target) {
+        const int cell = randomCell();
+        if (!inOpening(cell) && !board.isMine(cell / cols, cell % cols)) {
+            board.setMine(cell / cols, cell % cols, true);
+        }
+    }
+    while (board.mineCount() > target) {
+        const int cell = randomCell();
+        if (board.isMine(cell / cols, cell % cols)) {
+            board.setMine(cell / cols, cell % cols, false);
+        }
+    }
+}
+
+// 棋盘的对称变换：水平、垂直翻转的组合，方形棋盘再加上转置
+BoardEngine transformed(const BoardEngine &board, int symmetry)
+{
+    const int rows = board.rows();
+    const int cols = board.cols();
+    std::vector<int> mines;
+    mines.reserve(board.mineCount());
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            if (!board.isMine(r, c)) {
+                continue;
+            }
+            int nr = (symmetry & 1) ? rows - 1 - r : r;
+            int nc = (symmetry & 2) ? cols - 1 - c : c;
+            if (symmetry & 4) {
+                std::swap(nr, nc);
+            }
+            mines.push_back(nr * cols + nc);
+        }
+    }
+
+    BoardEngine result;
+    result.reset(rows, cols, board.mineCount());
+    result.setMineLayout(mines);
+    return result;
+}
+
+} // namespace
+
+BoardPrefetcher::~BoardPrefetcher()
+{
+    // 排队中的任务看到停止标志后直接返回，m_worker 析构时等待正在生成的那一块
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+}
+
+void BoardPrefetcher::prefetch(const Key &key)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!(key == m_current)) {
+            m_current = key;
+            for (auto it = m_boards.begin(); it != m_boards.end();) {
+                it = it->first == key ? std::next(it) : m_boards.erase(it);
+            }
+        }
+    }
+    refill();
+}
+
+void BoardPrefetcher::refill()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stopping || m_current.rows <= 0 || m_current.cols <= 0) {
+        return;
+    }
+    if (m_nextSeed == 0) {
+        m_nextSeed = threadLocalRandom();
+    }
+
+    const Key key = m_current;
+    const int target = static_cast<long long>(key.rows) * key.cols > LargeBoardCells ? 1 : PoolSize;
+    const int missing = target - static_cast<int>(m_boards[key].size()) - m_inFlight[key];
+    for (int i = 0; i < missing; ++i) {
+        const std::uint64_t seed = mix64(m_nextSeed++);
+        m_inFlight[key]++;
+        m_worker.submit([this, key, seed] { generate(key, seed); });
+    }
+}
+
+void BoardPrefetcher::generate(const Key &key, std::uint64_t seed)
+{
+    TRACE_SPAN("BoardPrefetcher::generate");
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping || !(key == m_current)) {
+            m_inFlight[key]--; // 难度已经改变，不再需要
+            return;
+        }
+    }
+
+    BoardEngine board;
+    board.reset(key.rows, key.cols, key.mines);
+    if (key.mode == NoGuess) {
+        // 无猜棋盘只能相对某个首次点击验证。锚点按种子在全盘均匀选取，
+        // 开局区的空白不会固定落在同一处；取出时仍会偏向"点击处之外另有一块开局区"，
+        // 这是无猜布局本身的条件，予以接受
+        const std::uint64_t pick = mix64(seed);
+        const int anchorRow = static_cast<int>((pick & 0xFFFFFFFFu) % static_cast<std::uint64_t>(key.rows));
+        const int anchorCol = static_cast<int>((pick >> 32) % static_cast<std::uint64_t>(key.cols));
+        std::uint64_t boardSeed = seed;
+        m_generator.generate(key.rows, key.cols, key.mines, anchorRow, anchorCol, seed, &boardSeed);
+        board.placeMines(anchorRow, anchorCol, boardSeed);
+    } else {
+        // 点击位置在棋盘外，没有安全区：全盘均匀布雷，取出时 clearOpening 再按实际点击调整
+        board.placeMines(-2, -2, seed);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_inFlight[key]--;
+    if (key.mode == NoGuess) {
+        m_stats[key] = m_generator.stats(key.rows, key.cols, key.mines);
+    }
+    if (!m_stopping && key == m_current) {
+        m_boards[key].push_back(std::move(board));
+    }
+}
+
+bool BoardPrefetcher::anchor(const Key &key, int firstRow, int firstCol, BoardEngine *board)
+{
+    const std::uint64_t seed = board->seed() ^ mix64(static_cast<std::uint64_t>(firstRow * key.cols + firstCol));
+    if (key.mode == Standard) {
+        clearOpening(*board, firstRow, firstCol, key.mines, seed);
+        return true;
+    }
+
+    // 无猜模式：原样和各个对称变换依次尝试，移走开局区的地雷后重新验证
+    const int symmetries = key.rows == key.cols ? 8 : 4;
+    for (int symmetry = 0; symmetry < symmetries; ++symmetry) {
+        BoardEngine candidate = symmetry == 0 ? *board : transformed(*board, symmetry);
+        clearOpening(candidate, firstRow, firstCol, key.mines, seed);
+        BoardEngine trial = candidate;
+        if (NoGuessGenerator::isSolvable(trial, firstRow, firstCol)) {
+            *board = std::move(candidate);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BoardPrefetcher::take(const Key &key, int firstRow, int firstCol, BoardEngine *engine)
+{
+    TRACE_SPAN("BoardPrefetcher::take");
+    bool taken = false;
+    for (;;) {
+        BoardEngine board;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_boards.find(key);
+            if (it == m_boards.end() || it->second.empty()) {
+                break;
+            }
+            board = std::move(it->second.front());
+            it->second.pop_front();
+        }
+
+        // 锚定失败的棋盘直接丢弃，继续尝试下一块
+        if (anchor(key, firstRow, firstCol, &board)) {
+            *engine = std::move(board);
+            taken = true;
+            break;
+        }
+    }
+    refill();
+    return taken;
+}
+
+int BoardPrefetcher::available(const Key &key) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_boards.find(key);
+    return it != m_boards.end() ? static_cast<int>(it->second.size()) : 0;
+}
+
+NoGuessGenerator::Stats BoardPrefetcher::generatorStats(const Key &key) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_stats.find(key);
+    return it != m_stats.end() ? it->second : NoGuessGenerator::Stats();
+}
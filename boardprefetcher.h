@@ -0,0 +1,82 @@
+#ifndef BOARDPREFETCHER_H
+#define BOARDPREFETCHER_H
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include "boardengine.h"
+#include "noguess.h"
+#include "threadpool.h"
+
+// 后台预生成棋盘：玩家游戏时在工作线程上为当前难度准备几块已布雷、
+// 已计算计数的棋盘。普通棋盘在全盘均匀布雷，首次点击时取出一块并重新锚定到
+// 实际点击位置：移走点击处3x3内的地雷，在区外随机补足 placeMines 会放置的雷数，
+// 分布与直接生成相同；无猜模式还会尝试棋盘的对称变换，只接受从该位置仍然
+// 不需要猜测的结果。
+// 取出的棋盘整体移入游戏引擎，首次点击不再承担生成的开销
+class BoardPrefetcher
+{
+public:
+    enum Mode {
+        Standard,
+        NoGuess
+    };
+
+    struct Key {
+        int rows;
+        int cols;
+        int mines;
+        Mode mode;
+
+        bool operator<(const Key &other) const
+        {
+            return std::tie(rows, cols, mines, mode) < std::tie(other.rows, other.cols, other.mines, other.mode);
+        }
+        bool operator==(const Key &other) const
+        {
+            return std::tie(rows, cols, mines, mode) == std::tie(other.rows, other.cols, other.mines, other.mode);
+        }
+    };
+
+    // 每种参数最多预备的棋盘数；超大棋盘每块占用上百兆内存，只预备一块
+    static const int PoolSize = 3;
+    static const int LargeBoardCells = 1 << 22;
+
+    BoardPrefetcher() = default;
+    ~BoardPrefetcher();
+
+    // 开始为 key 补充棋盘，其他参数的库存被丢弃
+    void prefetch(const Key &key);
+
+    // 取出一块锚定到 (firstRow, firstCol) 的棋盘移入 engine，之后自动补充。
+    // 没有可用的棋盘时返回 false，engine 不变
+    bool take(const Key &key, int firstRow, int firstCol, BoardEngine *engine);
+
+    int available(const Key &key) const;
+
+    // 后台无猜生成的统计
+    NoGuessGenerator::Stats generatorStats(const Key &key) const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<Key, std::deque<BoardEngine>> m_boards;
+    std::map<Key, NoGuessGenerator::Stats> m_stats;
+    std::map<Key, int> m_inFlight; // 已提交但尚未完成的生成任务
+    Key m_current{0, 0, 0, Standard};
+    bool m_stopping = false;
+    std::uint64_t m_nextSeed = 0;
+
+    // 只在工作线程上使用
+    NoGuessGenerator m_generator;
+
+    // 放在最后：析构时最先等待工作线程结束
+    ThreadPool m_worker{1};
+
+    void refill();
+    void generate(const Key &key, std::uint64_t seed);
+    static bool anchor(const Key &key, int firstRow, int firstCol, BoardEngine *board);
+};
+
+#endif // BOARDPREFETCHER_H
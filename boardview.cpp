@@ -0,0 +1,449 @@
+#include "boardview.h"
+#include "trace.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QScrollBar>
+
+namespace {
+
+// 兼容 Qt5/Qt6 的鼠标坐标获取
+QPoint mousePos(const QMouseEvent *event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return event->position().toPoint();
+#else
+    return event->pos();
+#endif
+}
+
+QPoint wheelPos(const QWheelEvent *event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    return event->position().toPoint();
+#else
+    return event->pos();
+#endif
+}
+
+// 向下取整的整数除法，用于换算视口外（负坐标）的行列
+int floorDiv(int value, int divisor)
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+const int MinCellSize = 1;       // 缩放下限
+const int MaxCellSize = 128;     // 缩放上限
+const int MinFitCellSize = 20;   // 自适应时的最小单元格，更小时改为滚动
+const int DefaultCellSize = 30;
+const int CoarseCellSize = 8;    // 小于该尺寸时使用粗略绘制
+const int MaxMinimumExtent = 400;
+const int MinHintExtent = 10;    // 提示框的最小边长
+const int HintPenWidth = 2;
+
+} // namespace
+
+BoardView::BoardView(QWidget *parent) : QAbstractScrollArea(parent)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    setFrameShape(QFrame::NoFrame);
+    setFocusPolicy(Qt::ClickFocus);
+    viewport()->setMouseTracking(true); // 悬停效果需要
+    viewport()->setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void BoardView::setEngine(const BoardEngine *engine)
+{
+    m_engine = engine;
+    resetView();
+}
+
+void BoardView::resetView()
+{
+    // 视图不复制棋盘状态，绘制时直接读取引擎
+    m_pressedRow = m_pressedCol = -1;
+    m_hintRow = m_hintCol = -1;
+
+    const int rows = m_engine ? m_engine->rows() : 0;
+    const int cols = m_engine ? m_engine->cols() : 0;
+    if (rows != m_layoutRows || cols != m_layoutCols) {
+        m_hoverRow = m_hoverCol = -1;
+        m_fitToView = true;
+        updateLayout();
+        updateGeometry();
+    }
+    viewport()->update();
+}
+
+void BoardView::applyChanges(const BoardEngine::ChangeSet &changes)
+{
+    TRACE_SPAN("BoardView::applyChanges");
+    if (!m_engine) {
+        return;
+    }
+
+    if (changes.fullUpdate || m_engine->rows() != m_layoutRows || m_engine->cols() != m_layoutCols) {
+        resetView();
+        return;
+    }
+
+    const int cols = m_layoutCols;
+    for (const BoardEngine::CellChange &change : changes.cells) {
+        if (change.oldState != change.newState) {
+            updateCell(change.index / cols, change.index % cols);
+        }
+    }
+}
+
+QRect BoardView::cellRect(int row, int col) const
+{
+    return QRect(m_origin.x() + col * m_cellSize, m_origin.y() + row * m_cellSize,
+                 m_cellSize, m_cellSize);
+}
+
+bool BoardView::cellAt(const QPoint &pos, int *row, int *col) const
+{
+    if (!m_engine || m_cellSize <= 0) {
+        return false;
+    }
+
+    QPoint local = pos - m_origin;
+    if (local.x() < 0 || local.y() < 0) {
+        return false;
+    }
+
+    int r = local.y() / m_cellSize;
+    int c = local.x() / m_cellSize;
+    if (!m_engine->isValidCell(r, c)) {
+        return false;
+    }
+
+    *row = r;
+    *col = c;
+    return true;
+}
+
+void BoardView::setCellSize(int cellSize, const QPoint &anchor)
+{
+    cellSize = qBound(MinCellSize, cellSize, MaxCellSize);
+    m_fitToView = false;
+    if (cellSize == m_cellSize) {
+        return;
+    }
+
+    // 锚点下的棋盘位置（以单元格为单位）
+    const double boardX = double(anchor.x() - m_origin.x()) / m_cellSize;
+    const double boardY = double(anchor.y() - m_origin.y()) / m_cellSize;
+
+    m_cellSize = cellSize;
+    updateScrollBars();
+    horizontalScrollBar()->setValue(qRound(boardX * cellSize - anchor.x()));
+    verticalScrollBar()->setValue(qRound(boardY * cellSize - anchor.y()));
+    updateOrigin();
+    viewport()->update();
+}
+
+void BoardView::fitToView()
+{
+    m_fitToView = true;
+    updateLayout();
+    viewport()->update();
+}
+
+QSize BoardView::sizeHint() const
+{
+    if (!m_engine) {
+        return QSize(DefaultCellSize * 9, DefaultCellSize * 9);
+    }
+    return QSize(m_engine->cols() * DefaultCellSize, m_engine->rows() * DefaultCellSize);
+}
+
+QSize BoardView::minimumSizeHint() const
+{
+    if (!m_engine) {
+        return QSize(MinFitCellSize, MinFitCellSize);
+    }
+    // 大棋盘可以滚动，最小尺寸不随棋盘无限增长
+    return QSize(qMin(m_engine->cols() * MinFitCellSize, MaxMinimumExtent),
+                 qMin(m_engine->rows() * MinFitCellSize, MaxMinimumExtent));
+}
+
+void BoardView::updateLayout()
+{
+    m_layoutRows = m_engine ? m_engine->rows() : 0;
+    m_layoutCols = m_engine ? m_engine->cols() : 0;
+
+    if (m_fitToView && m_layoutRows > 0 && m_layoutCols > 0) {
+        // 单元格保持正方形比例，尽量铺满视口
+        const QSize size = viewport()->size();
+        m_cellSize = qMax(MinFitCellSize, qMin(size.width() / m_layoutCols,
+                                               size.height() / m_layoutRows));
+    }
+
+    updateScrollBars();
+    updateOrigin();
+}
+
+void BoardView::updateScrollBars()
+{
+    const QSize size = viewport()->size();
+    const int contentWidth = m_layoutCols * m_cellSize;
+    const int contentHeight = m_layoutRows * m_cellSize;
+
+    horizontalScrollBar()->setRange(0, qMax(0, contentWidth - size.width()));
+    horizontalScrollBar()->setPageStep(size.width());
+    horizontalScrollBar()->setSingleStep(qMax(1, m_cellSize));
+    verticalScrollBar()->setRange(0, qMax(0, contentHeight - size.height()));
+    verticalScrollBar()->setPageStep(size.height());
+    verticalScrollBar()->setSingleStep(qMax(1, m_cellSize));
+}
+
+void BoardView::updateOrigin()
+{
+    // 棋盘小于视口时居中，否则跟随滚动条
+    const QSize size = viewport()->size();
+    const int contentWidth = m_layoutCols * m_cellSize;
+    const int contentHeight = m_layoutRows * m_cellSize;
+    const int x = contentWidth <= size.width() ? (size.width() - contentWidth) / 2
+                                               : -horizontalScrollBar()->value();
+    const int y = contentHeight <= size.height() ? (size.height() - contentHeight) / 2
+                                                 : -verticalScrollBar()->value();
+    m_origin = QPoint(x, y);
+}
+
+void BoardView::updateCell(int row, int col)
+{
+    viewport()->update(cellRect(row, col));
+}
+
+void BoardView::setHoverCell(int row, int col)
+{
+    if (row == m_hoverRow && col == m_hoverCol) {
+        return;
+    }
+    if (m_hoverRow >= 0) {
+        updateCell(m_hoverRow, m_hoverCol);
+    }
+    m_hoverRow = row;
+    m_hoverCol = col;
+    if (m_hoverRow >= 0) {
+        updateCell(m_hoverRow, m_hoverCol);
+    }
+}
+
+void BoardView::paintEvent(QPaintEvent *event)
+{
+    TRACE_SPAN("BoardView::paint");
+    QPainter painter(viewport());
+    const QRect dirty = event->rect();
+    painter.fillRect(dirty, palette().window());
+
+    if (!m_engine || m_layoutRows <= 0 || m_layoutCols <= 0) {
+        return;
+    }
+
+    // 只处理与脏区域相交的可见单元格
+    const QRect local = dirty.translated(-m_origin);
+    const int firstRow = qMax(0, floorDiv(local.top(), m_cellSize));
+    const int lastRow = qMin(m_layoutRows - 1, floorDiv(local.bottom(), m_cellSize));
+    const int firstCol = qMax(0, floorDiv(local.left(), m_cellSize));
+    const int lastCol = qMin(m_layoutCols - 1, floorDiv(local.right(), m_cellSize));
+    if (firstRow > lastRow || firstCol > lastCol) {
+        return;
+    }
+
+    if (m_cellSize >= CoarseCellSize) {
+        paintTiles(painter, firstRow, lastRow, firstCol, lastCol);
+    } else {
+        paintCoarse(painter, firstRow, lastRow, firstCol, lastCol);
+    }
+
+    // 提示框画在单元格之上
+    if (m_hintRow >= 0
+        && hintRect().adjusted(-HintPenWidth, -HintPenWidth, HintPenWidth, HintPenWidth).intersects(dirty)) {
+        painter.setPen(QPen(m_hintSafe ? QColor("#2E7D32") : QColor("#F9A825"), HintPenWidth));
+        painter.setBrush(Qt::NoBrush);
+        painter.drawRect(hintRect());
+    }
+}
+
+void BoardView::setHintCell(int row, int col, bool safe)
+{
+    if (m_hintRow >= 0) {
+        viewport()->update(hintRect().adjusted(-HintPenWidth, -HintPenWidth, HintPenWidth, HintPenWidth));
+    }
+    m_hintRow = row;
+    m_hintCol = col;
+    m_hintSafe = safe;
+    if (m_hintRow >= 0) {
+        viewport()->update(hintRect().adjusted(-HintPenWidth, -HintPenWidth, HintPenWidth, HintPenWidth));
+    }
+}
+
+QRect BoardView::hintRect() const
+{
+    // 缩小到看不清单元格时，提示框保持最小尺寸以便找到
+    const QRect cell = cellRect(m_hintRow, m_hintCol);
+    if (cell.width() >= MinHintExtent) {
+        return cell.adjusted(1, 1, -1, -1);
+    }
+    QRect rect(0, 0, MinHintExtent, MinHintExtent);
+    rect.moveCenter(cell.center());
+    return rect;
+}
+
+void BoardView::paintTiles(QPainter &painter, int firstRow, int lastRow, int firstCol, int lastCol)
+{
+    // 贴图集只在缩放或像素比变化时重建
+    m_atlas.ensure(m_cellSize, devicePixelRatioF());
+    const QPixmap &atlas = m_atlas.pixmap();
+
+    for (int row = firstRow; row <= lastRow; ++row) {
+        const std::uint8_t *states = &m_engine->cells()[static_cast<size_t>(row) * m_layoutCols];
+        for (int col = firstCol; col <= lastCol; ++col) {
+            const bool hover = row == m_hoverRow && col == m_hoverCol;
+            const TileAtlas::Tile tile = TileAtlas::tileFor(states[col], hover);
+            painter.drawPixmap(cellRect(row, col), atlas, m_atlas.sourceRect(tile));
+        }
+    }
+}
+
+void BoardView::paintCoarse(QPainter &painter, int firstRow, int lastRow, int firstCol, int lastCol)
+{
+    // 每个单元格一个像素写入图像，再整体放大绘制
+    const int width = lastCol - firstCol + 1;
+    const int height = lastRow - firstRow + 1;
+    if (m_coarseImage.width() < width || m_coarseImage.height() < height) {
+        m_coarseImage = QImage(qMax(width, m_coarseImage.width()),
+                               qMax(height, m_coarseImage.height()), QImage::Format_RGB32);
+    }
+
+    QRgb colors[TileAtlas::TileCount];
+    for (int tile = 0; tile < TileAtlas::TileCount; ++tile) {
+        colors[tile] = TileAtlas::coarseColor(static_cast<TileAtlas::Tile>(tile));
+    }
+
+    for (int y = 0; y < height; ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(m_coarseImage.scanLine(y));
+        const std::uint8_t *states =
+            &m_engine->cells()[static_cast<size_t>(firstRow + y) * m_layoutCols + firstCol];
+        for (int x = 0; x < width; ++x) {
+            line[x] = colors[TileAtlas::tileFor(states[x], false)];
+        }
+    }
+
+    const QRect target(m_origin.x() + firstCol * m_cellSize, m_origin.y() + firstRow * m_cellSize,
+                       width * m_cellSize, height * m_cellSize);
+    painter.drawImage(target, m_coarseImage, QRect(0, 0, width, height));
+}
+
+void BoardView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateLayout();
+}
+
+void BoardView::scrollContentsBy(int dx, int dy)
+{
+    // 平移时直接搬移已绘制的像素，只重绘新露出的区域
+    updateOrigin();
+    viewport()->scroll(dx, dy);
+}
+
+bool BoardView::viewportEvent(QEvent *event)
+{
+    if (event->type() == QEvent::Leave) {
+        setHoverCell(-1, -1);
+    }
+    const bool handled = QAbstractScrollArea::viewportEvent(event);
+    if (event->type() == QEvent::Paint) {
+        Trace::endInteraction(); // 之前的输入引起的变化已经画出
+    }
+    return handled;
+}
+
+void BoardView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::MiddleButton) {
+        // 中键拖动平移
+        m_panning = true;
+        m_panLast = mousePos(event);
+        viewport()->setCursor(Qt::ClosedHandCursor);
+        return;
+    }
+
+    int row, col;
+    if (!cellAt(mousePos(event), &row, &col)) {
+        QAbstractScrollArea::mousePressEvent(event);
+        return;
+    }
+
+    if (event->button() == Qt::LeftButton) {
+        // 左键在释放时才生效，与按钮的点击行为一致
+        m_pressedRow = row;
+        m_pressedCol = col;
+    } else if (event->button() == Qt::RightButton) {
+        emit cellRightClicked(row, col);
+    }
+}
+
+void BoardView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::MiddleButton && m_panning) {
+        m_panning = false;
+        viewport()->unsetCursor();
+        return;
+    }
+
+    if (event->button() != Qt::LeftButton) {
+        QAbstractScrollArea::mouseReleaseEvent(event);
+        return;
+    }
+
+    int row, col;
+    bool onCell = cellAt(mousePos(event), &row, &col);
+    bool samePressedCell = onCell && row == m_pressedRow && col == m_pressedCol;
+    m_pressedRow = m_pressedCol = -1;
+
+    if (samePressedCell) {
+        emit cellClicked(row, col);
+    }
+}
+
+void BoardView::mouseMoveEvent(QMouseEvent *event)
+{
+    const QPoint pos = mousePos(event);
+    if (m_panning) {
+        const QPoint delta = pos - m_panLast;
+        m_panLast = pos;
+        horizontalScrollBar()->setValue(horizontalScrollBar()->value() - delta.x());
+        verticalScrollBar()->setValue(verticalScrollBar()->value() - delta.y());
+        return;
+    }
+
+    int row, col;
+    if (m_cellSize >= CoarseCellSize && cellAt(pos, &row, &col)) {
+        setHoverCell(row, col);
+    } else {
+        setHoverCell(-1, -1);
+    }
+    QAbstractScrollArea::mouseMoveEvent(event);
+}
+
+void BoardView::wheelEvent(QWheelEvent *event)
+{
+    if (!(event->modifiers() & Qt::ControlModifier)) {
+        QAbstractScrollArea::wheelEvent(event);
+        return;
+    }
+
+    // Ctrl+滚轮以鼠标位置为中心缩放
+    const int delta = event->angleDelta().y();
+    if (delta > 0) {
+        setCellSize(qMax(m_cellSize + 1, m_cellSize * 5 / 4), wheelPos(event));
+    } else if (delta < 0) {
+        setCellSize(qMin(m_cellSize - 1, m_cellSize * 4 / 5), wheelPos(event));
+    }
+    event->accept();
+}
@@ -0,0 +1,98 @@
+#ifndef BOARDVIEW_H
+#define BOARDVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QImage>
+#include "tileatlas.h"
+#include "boardengine.h"
+
+// 自绘的游戏板视图：一次 paintEvent 只绘制视口内可见且需要重绘的单元格，
+// 鼠标坐标直接换算成行列。棋盘大于视口时可以滚动，Ctrl+滚轮缩放，
+// 中键拖动平移；单元格过小时改用每格一个色块的粗略绘制。
+// 绘制开销和内存只与视口大小有关，与棋盘大小无关
+class BoardView : public QAbstractScrollArea
+{
+    Q_OBJECT
+
+public:
+    explicit BoardView(QWidget *parent = nullptr);
+
+    // 设置要显示的引擎（不获取所有权）
+    void setEngine(const BoardEngine *engine);
+
+    // 引擎被重置后调用，行列数不变时只刷新内容，不重新计算布局
+    void resetView();
+
+    // 按变更集只重绘状态变化的单元格
+    void applyChanges(const BoardEngine::ChangeSet &changes);
+
+    // 在单元格上画出提示框，行为负时清除；safe 决定颜色
+    void setHintCell(int row, int col, bool safe);
+    void clearHint() { setHintCell(-1, -1, false); }
+
+    // 坐标换算（视口坐标）
+    QRect cellRect(int row, int col) const;
+    bool cellAt(const QPoint &pos, int *row, int *col) const;
+
+    // 缩放：anchor 处的单元格在缩放前后保持在原来的屏幕位置
+    int cellSize() const { return m_cellSize; }
+    void setCellSize(int cellSize, const QPoint &anchor);
+    void fitToView();
+
+    QSize sizeHint() const override;
+    QSize minimumSizeHint() const override;
+
+signals:
+    void cellClicked(int row, int col);
+    void cellRightClicked(int row, int col);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    bool viewportEvent(QEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+
+private:
+    const BoardEngine *m_engine = nullptr;
+
+    // 单元格贴图，尺寸或像素比变化时重建
+    TileAtlas m_atlas;
+
+    // 粗略绘制用的图像，每格一个像素，只覆盖可见区域
+    QImage m_coarseImage;
+
+    // 布局参数
+    int m_layoutRows = 0;
+    int m_layoutCols = 0;
+    int m_cellSize = 30;
+    bool m_fitToView = true; // 玩家缩放之前，单元格大小随视口自适应
+    QPoint m_origin;         // 棋盘左上角在视口中的位置
+
+    // 鼠标状态
+    int m_hoverRow = -1;
+    int m_hoverCol = -1;
+    int m_pressedRow = -1;
+    int m_pressedCol = -1;
+    bool m_panning = false;
+    QPoint m_panLast;
+
+    // 提示的单元格
+    int m_hintRow = -1;
+    int m_hintCol = -1;
+    bool m_hintSafe = false;
+
+    void updateLayout();
+    void updateScrollBars();
+    void updateOrigin();
+    void updateCell(int row, int col);
+    QRect hintRect() const;
+    void setHoverCell(int row, int col);
+    void paintTiles(QPainter &painter, int firstRow, int lastRow, int firstCol, int lastCol);
+    void paintCoarse(QPainter &painter, int firstRow, int lastRow, int firstCol, int lastCol);
+};
+
+#endif // BOARDVIEW_H
@@ -0,0 +1,327 @@
+#include "chunkedboard.h"
+#include "boardengine.h"
+#include "rng.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const std::uint8_t CountMask = BoardEngine::CountMask;
+const std::uint8_t MineBit = BoardEngine::MineBit;
+const std::uint8_t RevealedBit = BoardEngine::RevealedBit;
+const std::uint8_t FlaggedBit = BoardEngine::FlaggedBit;
+
+} // namespace
+
+void ChunkedBoard::reset(std::uint64_t seed, double density)
+{
+    m_seed = seed;
+    density = std::min(std::max(density, 0.0), 0.9);
+    m_mineThreshold = static_cast<std::uint64_t>(density * 18446744073709551615.0);
+    m_started = false;
+    m_gameOver = false;
+    m_startRow = m_startCol = 0;
+    m_revealedCount = 0;
+    m_flaggedCount = 0;
+
+    m_chunks.clear();
+    m_compressed.clear();
+    m_cachedChunk = nullptr;
+    m_changedCells.clear();
+    m_pending.clear();
+}
+
+bool ChunkedBoard::mineAt(int row, int col) const
+{
+    // 开局位置周围3x3保证安全
+    if (m_started && std::abs(row - m_startRow) <= 1 && std::abs(col - m_startCol) <= 1) {
+        return false;
+    }
+    const std::uint64_t position = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(row)) << 32)
+                                   | static_cast<std::uint32_t>(col);
+    return mix64(m_seed ^ (position * 0x9E3779B97F4A7C15ULL)) < m_mineThreshold;
+}
+
+void ChunkedBoard::generateChunk(Chunk &chunk, int chunkRow, int chunkCol) const
+{
+    // 带一圈边框的地雷网格，边框来自相邻块，计数时不需要判断边界
+    const int Border = ChunkSize + 2;
+    std::uint8_t mines[Border * Border];
+    const int top = chunkRow * ChunkSize - 1;
+    const int left = chunkCol * ChunkSize - 1;
+    for (int r = 0; r < Border; ++r) {
+        for (int c = 0; c < Border; ++c) {
+            mines[r * Border + c] = mineAt(top + r, left + c) ? 1 : 0;
+        }
+    }
+
+    chunk.hiddenSafe = 0;
+    chunk.touched = 0;
+    for (int r = 0; r < ChunkSize; ++r) {
+        const std::uint8_t *above = mines + r * Border;
+        const std::uint8_t *middle = above + Border;
+        const std::uint8_t *below = middle + Border;
+        for (int c = 0; c < ChunkSize; ++c) {
+            std::uint8_t &cell = chunk.cells[r * ChunkSize + c];
+            if (middle[c + 1]) {
+                cell = MineBit;
+                continue;
+            }
+            cell = static_cast<std::uint8_t>(above[c] + above[c + 1] + above[c + 2]
+                                             + middle[c] + middle[c + 2]
+                                             + below[c] + below[c + 1] + below[c + 2]);
+            chunk.hiddenSafe++;
+        }
+    }
+}
+
+void ChunkedBoard::restoreChunk(Chunk &chunk, const CompressedChunk &compressed) const
+{
+    // 压缩的块已完全解开：安全格全部揭开，地雷按位图恢复标记
+    for (int i = 0; i < ChunkCells; ++i) {
+        std::uint8_t &cell = chunk.cells[i];
+        if (!(cell & MineBit)) {
+            cell |= RevealedBit;
+            chunk.touched++;
+        } else if (!compressed.flagBits.empty() && (compressed.flagBits[i / 64] >> (i % 64) & 1)) {
+            cell |= FlaggedBit;
+            chunk.touched++;
+        }
+    }
+    chunk.hiddenSafe = 0;
+}
+
+ChunkedBoard::Chunk &ChunkedBoard::chunkFor(int row, int col)
+{
+    const int chunkRow = chunkCoord(row);
+    const int chunkCol = chunkCoord(col);
+    const std::uint64_t key = chunkKey(chunkRow, chunkCol);
+    if (m_cachedChunk && key == m_cachedKey) {
+        return *m_cachedChunk;
+    }
+
+    std::unique_ptr<Chunk> &slot = m_chunks[key];
+    if (!slot) {
+        slot.reset(new Chunk);
+        generateChunk(*slot, chunkRow, chunkCol);
+        auto compressed = m_compressed.find(key);
+        if (compressed != m_compressed.end()) {
+            restoreChunk(*slot, compressed->second);
+            m_compressed.erase(compressed);
+        }
+    }
+
+    m_cachedKey = key;
+    m_cachedChunk = slot.get();
+    return *slot;
+}
+
+const ChunkedBoard::Chunk *ChunkedBoard::findChunk(int row, int col) const
+{
+    auto it = m_chunks.find(chunkKey(chunkCoord(row), chunkCoord(col)));
+    return it == m_chunks.end() ? nullptr : it->second.get();
+}
+
+std::uint8_t ChunkedBoard::cellAt(int row, int col) const
+{
+    const int local = localIndex(row, col);
+    if (const Chunk *chunk = findChunk(row, col)) {
+        return chunk->cells[local];
+    }
+
+    auto compressed = m_compressed.find(chunkKey(chunkCoord(row), chunkCoord(col)));
+    if (compressed == m_compressed.end()) {
+        return 0; // 尚未生成，视为未揭开
+    }
+
+    // 压缩的块：地雷按位图标记，其余为已揭开的数字
+    if (mineAt(row, col)) {
+        const std::vector<std::uint64_t> &flags = compressed->second.flagBits;
+        const bool flagged = !flags.empty() && (flags[local / 64] >> (local % 64) & 1);
+        return flagged ? (MineBit | FlaggedBit) : MineBit;
+    }
+    int count = 0;
+    for (int r = row - 1; r <= row + 1; ++r) {
+        for (int c = col - 1; c <= col + 1; ++c) {
+            count += (r != row || c != col) && mineAt(r, c) ? 1 : 0;
+        }
+    }
+    return static_cast<std::uint8_t>(RevealedBit | count);
+}
+
+const std::vector<ChunkedBoard::CellPos> &ChunkedBoard::revealCell(int row, int col)
+{
+    m_changedCells.clear();
+    if (m_gameOver) {
+        return m_changedCells;
+    }
+
+    // 第一次揭示确定安全区，此前不会生成任何块
+    if (!m_started) {
+        m_started = true;
+        m_startRow = row;
+        m_startCol = col;
+    }
+
+    Chunk &first = chunkFor(row, col);
+    std::uint8_t &cell = first.cells[localIndex(row, col)];
+    if (cell & (RevealedBit | FlaggedBit)) {
+        return m_changedCells;
+    }
+
+    // 踩雷：揭开所有已生成块中的地雷，没展开完的空白区域也不再继续
+    if (cell & MineBit) {
+        m_gameOver = true;
+        m_pending.clear();
+        for (auto &entry : m_chunks) {
+            const int chunkRow = static_cast<std::int32_t>(entry.first >> 32);
+            const int chunkCol = static_cast<std::int32_t>(entry.first & 0xFFFFFFFFu);
+            Chunk &chunk = *entry.second;
+            for (int i = 0; i < ChunkCells; ++i) {
+                if ((chunk.cells[i] & (MineBit | RevealedBit)) == MineBit) {
+                    chunk.cells[i] |= RevealedBit;
+                    m_changedCells.push_back({chunkRow * ChunkSize + i / ChunkSize,
+                                              chunkCol * ChunkSize + i % ChunkSize});
+                }
+            }
+        }
+        return m_changedCells;
+    }
+
+    revealSafe(first, cell, row, col);
+    runCascade(0);
+    return m_changedCells;
+}
+
+const std::vector<ChunkedBoard::CellPos> &ChunkedBoard::continueCascade()
+{
+    m_changedCells.clear();
+    if (m_gameOver || m_pending.empty()) {
+        return m_changedCells;
+    }
+
+    // 先展开上次留下的空白格，再按常规方式展开新揭开的格子；
+    // 这次又达到上限时剩余的部分重新排队
+    m_resume.swap(m_pending);
+    std::size_t next = 0;
+    while (next < m_resume.size() && m_changedCells.size() < static_cast<size_t>(MaxCascade)) {
+        expandAround(m_resume[next++]);
+    }
+    m_pending.assign(m_resume.begin() + next, m_resume.end());
+    m_resume.clear();
+    runCascade(0);
+    return m_changedCells;
+}
+
+void ChunkedBoard::revealSafe(Chunk &chunk, std::uint8_t &state, int row, int col)
+{
+    state |= RevealedBit;
+    chunk.hiddenSafe--;
+    chunk.touched++;
+    m_revealedCount++;
+    m_changedCells.push_back({row, col});
+}
+
+bool ChunkedBoard::isBlank(int row, int col)
+{
+    return !(chunkFor(row, col).cells[localIndex(row, col)] & CountMask);
+}
+
+void ChunkedBoard::expandAround(CellPos pos)
+{
+    // 相邻单元格大多在同一块内，块查找命中缓存
+    for (int r = pos.row - 1; r <= pos.row + 1; ++r) {
+        for (int c = pos.col - 1; c <= pos.col + 1; ++c) {
+            Chunk &chunk = chunkFor(r, c);
+            std::uint8_t &state = chunk.cells[localIndex(r, c)];
+            if (!(state & (RevealedBit | FlaggedBit))) {
+                revealSafe(chunk, state, r, c);
+            }
+        }
+    }
+}
+
+void ChunkedBoard::runCascade(std::size_t head)
+{
+    // 广度优先展开，m_changedCells 同时作为工作队列
+    for (; head < m_changedCells.size(); ++head) {
+        if (m_changedCells.size() >= static_cast<size_t>(MaxCascade)) {
+            // 达到上限：队列里还没展开的空白格留给 continueCascade
+            for (; head < m_changedCells.size(); ++head) {
+                if (isBlank(m_changedCells[head].row, m_changedCells[head].col)) {
+                    m_pending.push_back(m_changedCells[head]);
+                }
+            }
+            return;
+        }
+        const CellPos pos = m_changedCells[head];
+        if (isBlank(pos.row, pos.col)) {
+            expandAround(pos);
+        }
+    }
+}
+
+bool ChunkedBoard::toggleFlag(int row, int col)
+{
+    if (!m_started || m_gameOver) {
+        return false;
+    }
+
+    Chunk &chunk = chunkFor(row, col);
+    std::uint8_t &cell = chunk.cells[localIndex(row, col)];
+    if (cell & RevealedBit) {
+        return false;
+    }
+
+    cell ^= FlaggedBit;
+    const int delta = (cell & FlaggedBit) ? 1 : -1;
+    chunk.touched += delta;
+    m_flaggedCount += delta;
+    return true;
+}
+
+void ChunkedBoard::compact(int row, int col, int keepRadius)
+{
+    const int centerRow = chunkCoord(row);
+    const int centerCol = chunkCoord(col);
+
+    for (auto it = m_chunks.begin(); it != m_chunks.end();) {
+        const int chunkRow = static_cast<std::int32_t>(it->first >> 32);
+        const int chunkCol = static_cast<std::int32_t>(it->first & 0xFFFFFFFFu);
+        const Chunk &chunk = *it->second;
+        const bool far = std::abs(chunkRow - centerRow) > keepRadius
+                         || std::abs(chunkCol - centerCol) > keepRadius;
+
+        if (!far || (chunk.touched > 0 && chunk.hiddenSafe > 0)) {
+            ++it;
+            continue;
+        }
+
+        // 完全解开的块只保留标记位图；从未触碰的块可以原样重新生成，直接丢弃
+        if (chunk.touched > 0) {
+            CompressedChunk compressed;
+            for (int i = 0; i < ChunkCells; ++i) {
+                if (chunk.cells[i] & FlaggedBit) {
+                    if (compressed.flagBits.empty()) {
+                        compressed.flagBits.assign(ChunkCells / 64, 0);
+                    }
+                    compressed.flagBits[i / 64] |= std::uint64_t(1) << (i % 64);
+                }
+            }
+            m_compressed.emplace(it->first, std::move(compressed));
+        }
+        it = m_chunks.erase(it);
+    }
+
+    m_cachedChunk = nullptr;
+}
+
+size_t ChunkedBoard::memoryUsage() const
+{
+    size_t bytes = m_chunks.size() * (sizeof(Chunk) + sizeof(std::uint64_t) + sizeof(void *) * 2);
+    for (const auto &entry : m_compressed) {
+        bytes += sizeof(entry) + entry.second.flagBits.size() * sizeof(std::uint64_t);
+    }
+    return bytes;
+}
@@ -0,0 +1,119 @@
+#ifndef CHUNKEDBOARD_H
+#define CHUNKEDBOARD_H
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// 无尽模式的棋盘：世界按 ChunkSize x ChunkSize 分块，某一块第一次被访问时
+// 才根据 (种子, 块坐标) 确定性地生成地雷和计数。远离玩家且已完全解开的块
+// 会被压缩（只保留标记位图）或直接丢弃，需要时再原样重建。
+// 内存随已探索的区域增长，与名义上的世界大小无关。
+// 单元格字节的编码与 BoardEngine::CellBits 相同
+class ChunkedBoard
+{
+public:
+    static const int ChunkSize = 64;
+    static const int ChunkCells = ChunkSize * ChunkSize;
+
+    // 一次调用最多揭开的单元格数，地雷密度很低时空白区域可能无限大；
+    // 达到上限时还没展开的空白格留在队列里，由 continueCascade() 接着展开
+    static const int MaxCascade = 1 << 20;
+
+    struct CellPos {
+        int row;
+        int col;
+    };
+
+    // 开始新的世界，density 为每个单元格是地雷的概率
+    void reset(std::uint64_t seed, double density);
+
+    std::uint64_t seed() const { return m_seed; }
+    bool started() const { return m_started; }
+    bool isGameOver() const { return m_gameOver; }
+    long long revealedCount() const { return m_revealedCount; }
+    long long flaggedCount() const { return m_flaggedCount; }
+
+    // 查询单元格状态，不会触发生成；未生成的块视为全部未揭开
+    std::uint8_t cellAt(int row, int col) const;
+
+    // 单元格是否是地雷（无状态的哈希，不会触发生成），调试和基准用
+    bool isMine(int row, int col) const { return mineAt(row, col); }
+
+    // 揭示单元格并跨块展开空白区域，返回状态发生变化的单元格。
+    // 第一次揭示的位置及其周围3x3不会有地雷
+    const std::vector<CellPos> &revealCell(int row, int col);
+
+    // 继续展开因达到 MaxCascade 而中断的空白区域，同样最多揭开 MaxCascade 格，
+    // 返回状态发生变化的单元格。待展开的格子跨越压缩和丢弃保留
+    const std::vector<CellPos> &continueCascade();
+    bool cascadePending() const { return !m_pending.empty(); }
+    const std::vector<CellPos> &pendingCascade() const { return m_pending; }
+
+    // 切换标记状态（开局前无效），返回是否发生了变化
+    bool toggleFlag(int row, int col);
+
+    // 压缩或丢弃距离 (row, col) 超过 keepRadius 个块、且已完全解开或从未触碰的块
+    void compact(int row, int col, int keepRadius);
+
+    // 内存统计
+    size_t residentChunks() const { return m_chunks.size(); }
+    size_t compressedChunks() const { return m_compressed.size(); }
+    size_t memoryUsage() const;
+
+private:
+    struct Chunk {
+        std::uint8_t cells[ChunkCells];
+        int hiddenSafe = 0;   // 尚未揭开的安全格
+        int touched = 0;      // 已揭开或已标记的单元格数
+    };
+
+    // 已完全解开的块只需记住哪些地雷被标记了
+    struct CompressedChunk {
+        std::vector<std::uint64_t> flagBits; // 没有标记时为空
+    };
+
+    std::uint64_t m_seed = 0;
+    std::uint64_t m_mineThreshold = 0;
+    bool m_started = false;
+    bool m_gameOver = false;
+    int m_startRow = 0;
+    int m_startCol = 0;
+    long long m_revealedCount = 0;
+    long long m_flaggedCount = 0;
+
+    std::unordered_map<std::uint64_t, std::unique_ptr<Chunk>> m_chunks;
+    std::unordered_map<std::uint64_t, CompressedChunk> m_compressed;
+
+    // 最近访问的块，连续访问同一块时省去哈希查找
+    std::uint64_t m_cachedKey = 0;
+    Chunk *m_cachedChunk = nullptr;
+
+    std::vector<CellPos> m_changedCells;
+
+    // 已揭开但邻格还没展开的空白格（展开达到上限时留下），跨调用保留
+    std::vector<CellPos> m_pending;
+    std::vector<CellPos> m_resume;
+
+    static int chunkCoord(int value) { return value >= 0 ? value / ChunkSize : -((-value + ChunkSize - 1) / ChunkSize); }
+    static int localCoord(int value) { return value - chunkCoord(value) * ChunkSize; }
+    static std::uint64_t chunkKey(int chunkRow, int chunkCol)
+    {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(chunkRow)) << 32)
+               | static_cast<std::uint32_t>(chunkCol);
+    }
+
+    bool mineAt(int row, int col) const;
+    Chunk &chunkFor(int row, int col);
+    const Chunk *findChunk(int row, int col) const;
+    void generateChunk(Chunk &chunk, int chunkRow, int chunkCol) const;
+    void restoreChunk(Chunk &chunk, const CompressedChunk &compressed) const;
+    void revealSafe(Chunk &chunk, std::uint8_t &state, int row, int col);
+    bool isBlank(int row, int col);
+    void expandAround(CellPos pos);
+    void runCascade(std::size_t head);
+    static int localIndex(int row, int col) { return localCoord(row) * ChunkSize + localCoord(col); }
+};
+
+#endif // CHUNKEDBOARD_H
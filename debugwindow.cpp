@@ -1,31 +1,98 @@
 #include "debugwindow.h"
-#include "gameboard.h"
+#include "trace.h"
 #include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPainter>
 
-DebugWindow::DebugWindow(GameBoard *gameBoard, QWidget *parent)
-    : QDialog(parent), m_gameBoard(gameBoard)
+namespace {
+
+const int MaxCellPixels = 16;   // 小棋盘时每格最多放大到的像素数
+const int PreferredExtent = 640; // 默认窗口中地图的最大边长
+
+QRgb blend(QRgb from, QRgb to, float t)
+{
+    const float s = 1.0f - t;
+    return qRgb(static_cast<int>(qRed(from) * s + qRed(to) * t),
+                static_cast<int>(qGreen(from) * s + qGreen(to) * t),
+                static_cast<int>(qBlue(from) * s + qBlue(to) * t));
+}
+
+// 把地雷图按最近邻放大到控件中央，保持宽高比
+class MineMapView : public QWidget
+{
+public:
+    explicit MineMapView(const QImage *image, QWidget *parent = nullptr)
+        : QWidget(parent), m_image(image)
+    {
+        setAttribute(Qt::WA_OpaquePaintEvent);
+        setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    }
+
+    QSize sizeHint() const override
+    {
+        const int extent = qMax(m_image->width(), m_image->height());
+        const int scale = extent > 0 ? qBound(1, PreferredExtent / extent, MaxCellPixels) : 1;
+        return m_image->size() * scale;
+    }
+
+    QSize minimumSizeHint() const override { return QSize(100, 100); }
+
+protected:
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter painter(this);
+        painter.fillRect(rect(), palette().window());
+        if (m_image->isNull()) {
+            return;
+        }
+
+        const QSize target = m_image->size().scaled(size(), Qt::KeepAspectRatio);
+        const QRect targetRect(QPoint((width() - target.width()) / 2, (height() - target.height()) / 2), target);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+        painter.drawImage(targetRect, *m_image);
+    }
+
+private:
+    const QImage *m_image;
+};
+
+} // namespace
+
+DebugWindow::DebugWindow(const BoardEngine *engine, QWidget *parent)
+    : QDialog(parent), m_engine(engine)
 {
     setWindowTitle("调试模式 - 地雷位置");
     setWindowFlags(Qt::Window | Qt::WindowStaysOnTopHint);
-    
+
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
     mainLayout->setContentsMargins(10, 10, 10, 10);
     mainLayout->setSpacing(5);
-    
+
     // 添加标题标签
     QLabel *titleLabel = new QLabel("红色 = 地雷");
     titleLabel->setAlignment(Qt::AlignCenter);
     mainLayout->addWidget(titleLabel);
-    
-    // 创建网格布局用于显示地雷位置
-    m_gridLayout = new QGridLayout();
-    m_gridLayout->setSpacing(1); // 减小单元格之间的间距
-    m_gridLayout->setContentsMargins(0, 0, 0, 0);
-    mainLayout->addLayout(m_gridLayout);
-    
-    // 初始化标签网格
+
+    // 叠加层开关
+    QHBoxLayout *overlayLayout = new QHBoxLayout();
+    m_stateOverlay = new QCheckBox("显示揭开/标记");
+    m_heatmapOverlay = new QCheckBox("概率热图");
+    overlayLayout->addWidget(m_stateOverlay);
+    overlayLayout->addWidget(m_heatmapOverlay);
+    overlayLayout->addStretch();
+    mainLayout->addLayout(overlayLayout);
+    connect(m_stateOverlay, &QCheckBox::toggled, this, &DebugWindow::updateDisplay);
+    connect(m_heatmapOverlay, &QCheckBox::toggled, this, &DebugWindow::updateDisplay);
+    connect(m_heatmapOverlay, &QCheckBox::toggled, this, &DebugWindow::heatmapToggled);
+
+    // 地雷分布图
+    m_mapView = new MineMapView(&m_image);
+    mainLayout->addWidget(m_mapView, 1);
+
+    // 生成图像
     updateDisplay();
-    
+
     // 调整窗口大小
     adjustSize();
     setMinimumSize(200, 200);
@@ -35,53 +102,78 @@ DebugWindow::~DebugWindow()
 {
 }
 
-void DebugWindow::updateDisplay()
+QRgb DebugWindow::cellColor(int index, std::uint8_t state) const
 {
-    int rows = m_gameBoard->getRows();
-    int cols = m_gameBoard->getCols();
-    
-    // 如果行列数变化，重新创建标签网格
-    if (m_labels.size() != rows || (rows > 0 && m_labels[0].size() != cols)) {
-        // 清除现有标签
-        for (auto &row : m_labels) {
-            for (auto label : row) {
-                delete label;
-            }
-        }
-        m_labels.clear();
-        
-        // 清除布局中的所有项
-        while (m_gridLayout->count() > 0) {
-            QLayoutItem *item = m_gridLayout->takeAt(0);
-            if (item->widget()) {
-                delete item->widget();
-            }
-            delete item;
+    const bool mine = state & BoardEngine::MineBit;
+
+    if (m_stateOverlay->isChecked()) {
+        if (state & BoardEngine::FlaggedBit) {
+            return mine ? qRgb(0x1E, 0x88, 0xE5) : qRgb(0xFF, 0xA0, 0x00); // 正确/错误的标记
         }
-        
-        // 创建新的标签网格
-        m_labels.resize(rows);
-        for (int row = 0; row < rows; ++row) {
-            m_labels[row].resize(cols);
-            for (int col = 0; col < cols; ++col) {
-                QLabel *label = new QLabel();
-                label->setFixedSize(16, 16); // 减小标签大小
-                label->setAlignment(Qt::AlignCenter);
-                label->setStyleSheet("border: 1px solid #BBBBBB;");
-                m_gridLayout->addWidget(label, row, col);
-                m_labels[row][col] = label;
-            }
+        if (state & BoardEngine::RevealedBit) {
+            return mine ? qRgb(0xB7, 0x1C, 0x1C) : qRgb(0xFF, 0xFF, 0xFF);
         }
     }
-    
-    // 更新标签显示
+
+    // 热图：未揭开的单元格颜色随概率加深，地雷和安全格仍可区分
+    if (m_heatmapOverlay->isChecked() && static_cast<std::size_t>(index) < m_probabilities.size()
+        && !(state & (BoardEngine::RevealedBit | BoardEngine::FlaggedBit))) {
+        const float p = qBound(0.0f, m_probabilities[index], 1.0f);
+        return mine ? blend(qRgb(0xFF, 0xCD, 0xD2), qRgb(0xFF, 0x52, 0x52), p)
+                    : blend(qRgb(0xE0, 0xE0, 0xE0), qRgb(0x1A, 0x23, 0x7E), p);
+    }
+
+    return mine ? qRgb(0xFF, 0x52, 0x52) : qRgb(0xE0, 0xE0, 0xE0);
+}
+
+void DebugWindow::updateDisplay()
+{
+    TRACE_SPAN("DebugWindow::updateDisplay");
+    const BoardEngine &engine = *m_engine;
+    const int rows = engine.rows();
+    const int cols = engine.cols();
+
+    // 尺寸变化时重新分配图像，窗口的建议大小随之变化
+    if (m_image.width() != cols || m_image.height() != rows) {
+        m_image = QImage(cols, rows, QImage::Format_RGB32);
+        m_mapView->updateGeometry();
+    }
+
+    const std::uint8_t *cells = engine.cells().data();
     for (int row = 0; row < rows; ++row) {
+        QRgb *line = reinterpret_cast<QRgb *>(m_image.scanLine(row));
+        const int base = row * cols;
         for (int col = 0; col < cols; ++col) {
-            if (m_gameBoard->isMineAt(row, col)) {
-                m_labels[row][col]->setStyleSheet("background-color: #FF5252; border: 1px solid #BBBBBB;");
-            } else {
-                m_labels[row][col]->setStyleSheet("background-color: #E0E0E0; border: 1px solid #BBBBBB;");
-            }
+            line[col] = cellColor(base + col, cells[base + col]);
         }
     }
-} 
\ No newline at end of file
+    m_mapView->update();
+}
+
+void DebugWindow::applyChanges(const BoardEngine::ChangeSet &changes)
+{
+    TRACE_SPAN("DebugWindow::applyChanges");
+    const BoardEngine &engine = *m_engine;
+    const int cols = engine.cols();
+    if (changes.fullUpdate || m_image.width() != cols || m_image.height() != engine.rows()) {
+        updateDisplay();
+        return;
+    }
+
+    for (const BoardEngine::CellChange &change : changes.cells) {
+        const int row = change.index / cols;
+        const int col = change.index % cols;
+        reinterpret_cast<QRgb *>(m_image.scanLine(row))[col] = cellColor(change.index, change.newState);
+    }
+    if (!changes.cells.empty()) {
+        m_mapView->update();
+    }
+}
+
+void DebugWindow::setProbabilities(const std::vector<float> &probabilities)
+{
+    m_probabilities = probabilities;
+    if (m_heatmapOverlay->isChecked()) {
+        updateDisplay();
+    }
+}
@@ -2,26 +2,50 @@
 #define DEBUGWINDOW_H
 
 #include <QDialog>
-#include <QGridLayout>
-#include <QLabel>
-
-class GameBoard;
+#include <QImage>
+#include <QCheckBox>
+#include <vector>
+#include "boardengine.h"
 
+// 调试窗口：整张地雷分布图是一幅每格一个像素的 QImage，
+// 绘制时按窗口大小最近邻放大。变更集只改写变化单元格的像素，
+// 打开和刷新的开销与棋盘大小成线性且只做一次，不再为每格创建控件
 class DebugWindow : public QDialog
 {
     Q_OBJECT
 
 public:
-    explicit DebugWindow(GameBoard *gameBoard, QWidget *parent = nullptr);
+    // 显示 engine 的地雷分布（不获取所有权）
+    explicit DebugWindow(const BoardEngine *engine, QWidget *parent = nullptr);
     ~DebugWindow();
 
+    // 只更新变更集中变化的单元格
+    void applyChanges(const BoardEngine::ChangeSet &changes);
+
+    // 每个单元格的地雷概率（下标同引擎单元格，取值 0-1），为空表示没有可用的概率。
+    // 概率由持有引擎的一方计算：热图打开时每次变更后调用
+    void setProbabilities(const std::vector<float> &probabilities);
+    bool heatmapEnabled() const { return m_heatmapOverlay->isChecked(); }
+
+    const QImage &mineMap() const { return m_image; }
+
 public slots:
+    // 重新生成整幅图像
     void updateDisplay();
 
+signals:
+    // 打开热图时需要当前局面的概率
+    void heatmapToggled(bool enabled);
+
 private:
-    GameBoard *m_gameBoard;
-    QGridLayout *m_gridLayout;
-    QVector<QVector<QLabel*>> m_labels;
+    const BoardEngine *m_engine;
+    QWidget *m_mapView;
+    QCheckBox *m_stateOverlay;
+    QCheckBox *m_heatmapOverlay;
+    QImage m_image;
+    std::vector<float> m_probabilities;
+
+    QRgb cellColor(int index, std::uint8_t state) const;
 };
 
-#endif // DEBUGWINDOW_H 
\ No newline at end of file
+#endif // DEBUGWINDOW_H
@@ -0,0 +1,327 @@
+#include "endlessview.h"
+#include "trace.h"
+#include <QPainter>
+#include <QPaintEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QKeyEvent>
+#include <QResizeEvent>
+
+namespace {
+
+QPoint mousePos(const QMouseEvent *event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    return event->position().toPoint();
+#else
+    return event->pos();
+#endif
+}
+
+QPoint wheelPos(const QWheelEvent *event)
+{
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    return event->position().toPoint();
+#else
+    return event->pos();
+#endif
+}
+
+// 向下取整的整数除法，世界坐标可以为负
+qint64 floorDiv(qint64 value, qint64 divisor)
+{
+    return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+}
+
+const int MinCellSize = 8;   // 不做粗略绘制，缩小到贴图仍可辨认为止
+const int MaxCellSize = 128;
+const int DefaultCellSize = 30;
+const int DefaultExtent = 20; // 默认视口的单元格数
+
+} // namespace
+
+EndlessView::EndlessView(QWidget *parent) : QWidget(parent)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+    setFocusPolicy(Qt::ClickFocus);
+    setMouseTracking(true);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    // 分批继续超长的展开，每批之间处理输入和绘制
+    m_cascadeTimer = new QTimer(this);
+    m_cascadeTimer->setInterval(0);
+    connect(m_cascadeTimer, &QTimer::timeout, this, &EndlessView::continueCascade);
+}
+
+void EndlessView::newGame(std::uint64_t seed, double density)
+{
+    m_cascadeTimer->stop();
+    m_board.reset(seed, density);
+    m_cellSize = DefaultCellSize;
+
+    // 原点所在的单元格放在视口中央
+    m_viewX = -width() / 2;
+    m_viewY = -height() / 2;
+    m_compactChunkRow = m_compactChunkCol = 0;
+    m_hover = m_pressed = m_panning = false;
+    update();
+    emit progressChanged(0, 0);
+}
+
+QSize EndlessView::sizeHint() const
+{
+    return QSize(DefaultCellSize * DefaultExtent, DefaultCellSize * DefaultExtent);
+}
+
+bool EndlessView::cellAt(const QPoint &pos, int *row, int *col) const
+{
+    if (!rect().contains(pos)) {
+        return false;
+    }
+    *row = static_cast<int>(floorDiv(m_viewY + pos.y(), m_cellSize));
+    *col = static_cast<int>(floorDiv(m_viewX + pos.x(), m_cellSize));
+    return true;
+}
+
+QRect EndlessView::cellRect(int row, int col) const
+{
+    return QRect(static_cast<int>(qint64(col) * m_cellSize - m_viewX),
+                 static_cast<int>(qint64(row) * m_cellSize - m_viewY), m_cellSize, m_cellSize);
+}
+
+void EndlessView::paintEvent(QPaintEvent *event)
+{
+    TRACE_SPAN("EndlessView::paint");
+    QPainter painter(this);
+    const QRect dirty = event->rect();
+
+    // 只读取与脏区域相交的单元格；未生成的块按未揭开绘制，不会触发生成
+    m_atlas.ensure(m_cellSize, devicePixelRatioF());
+    const QPixmap &atlas = m_atlas.pixmap();
+    const int firstRow = static_cast<int>(floorDiv(m_viewY + dirty.top(), m_cellSize));
+    const int lastRow = static_cast<int>(floorDiv(m_viewY + dirty.bottom(), m_cellSize));
+    const int firstCol = static_cast<int>(floorDiv(m_viewX + dirty.left(), m_cellSize));
+    const int lastCol = static_cast<int>(floorDiv(m_viewX + dirty.right(), m_cellSize));
+    for (int row = firstRow; row <= lastRow; ++row) {
+        for (int col = firstCol; col <= lastCol; ++col) {
+            const bool hover = m_hover && row == m_hoverRow && col == m_hoverCol;
+            const TileAtlas::Tile tile = TileAtlas::tileFor(m_board.cellAt(row, col), hover);
+            painter.drawPixmap(cellRect(row, col), atlas, m_atlas.sourceRect(tile));
+        }
+    }
+    Trace::endInteraction(); // 之前的输入引起的变化已经画出
+}
+
+void EndlessView::resizeEvent(QResizeEvent *event)
+{
+    // 视口中心对应的世界位置保持不变
+    if (event->oldSize().isValid()) {
+        m_viewX -= (event->size().width() - event->oldSize().width()) / 2;
+        m_viewY -= (event->size().height() - event->oldSize().height()) / 2;
+    }
+    QWidget::resizeEvent(event);
+}
+
+void EndlessView::afterChange(const std::vector<ChunkedBoard::CellPos> &cells)
+{
+    if (cells.empty()) {
+        return;
+    }
+    update();
+    emit progressChanged(m_board.revealedCount(), m_board.flaggedCount());
+
+    if (m_board.isGameOver()) {
+        m_cascadeTimer->stop();
+        emit gameOver();
+        return;
+    }
+    if (m_board.cascadePending()) {
+        m_cascadeTimer->start();
+    }
+}
+
+void EndlessView::continueCascade()
+{
+    TRACE_SPAN("EndlessView::continueCascade");
+    afterChange(m_board.continueCascade());
+    if (!m_board.cascadePending()) {
+        m_cascadeTimer->stop();
+        // 展开可能解开了很多块，趁机压缩
+        compactAroundView();
+    }
+}
+
+void EndlessView::scrollBy(qint64 dx, qint64 dy)
+{
+    if (!dx && !dy) {
+        return;
+    }
+    m_viewX += dx;
+    m_viewY += dy;
+    m_hover = false;
+    scroll(static_cast<int>(-dx), static_cast<int>(-dy));
+
+    // 视口中心换到另一块时才压缩，平移时的开销与块数无关
+    const qint64 chunkPixels = qint64(ChunkedBoard::ChunkSize) * m_cellSize;
+    const int chunkRow = static_cast<int>(floorDiv(m_viewY + height() / 2, chunkPixels));
+    const int chunkCol = static_cast<int>(floorDiv(m_viewX + width() / 2, chunkPixels));
+    if (chunkRow != m_compactChunkRow || chunkCol != m_compactChunkCol) {
+        compactAroundView();
+    }
+}
+
+void EndlessView::compactAroundView()
+{
+    TRACE_SPAN("EndlessView::compact");
+    const int centerRow = static_cast<int>(floorDiv(m_viewY + height() / 2, m_cellSize));
+    const int centerCol = static_cast<int>(floorDiv(m_viewX + width() / 2, m_cellSize));
+    m_compactChunkRow = static_cast<int>(floorDiv(centerRow, ChunkedBoard::ChunkSize));
+    m_compactChunkCol = static_cast<int>(floorDiv(centerCol, ChunkedBoard::ChunkSize));
+
+    // 保留覆盖视口的块再加一圈，来回小幅平移时不会反复压缩和恢复
+    const int chunkPixels = ChunkedBoard::ChunkSize * m_cellSize;
+    const int keepRadius = (qMax(width(), height()) / 2 + chunkPixels - 1) / chunkPixels + 1;
+    m_board.compact(centerRow, centerCol, keepRadius);
+}
+
+void EndlessView::setCellSize(int cellSize, const QPoint &anchor)
+{
+    cellSize = qBound(MinCellSize, cellSize, MaxCellSize);
+    if (cellSize == m_cellSize) {
+        return;
+    }
+
+    // 锚点下的世界位置在缩放前后保持不变
+    const double worldX = double(m_viewX + anchor.x()) / m_cellSize;
+    const double worldY = double(m_viewY + anchor.y()) / m_cellSize;
+    m_cellSize = cellSize;
+    m_viewX = qRound64(worldX * cellSize) - anchor.x();
+    m_viewY = qRound64(worldY * cellSize) - anchor.y();
+    compactAroundView();
+    update();
+}
+
+void EndlessView::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::MiddleButton) {
+        m_panning = true;
+        m_panLast = mousePos(event);
+        setCursor(Qt::ClosedHandCursor);
+        return;
+    }
+
+    int row, col;
+    if (!cellAt(mousePos(event), &row, &col)) {
+        return;
+    }
+    if (event->button() == Qt::LeftButton) {
+        // 与普通棋盘一样，左键在释放时才生效
+        m_pressed = true;
+        m_pressedRow = row;
+        m_pressedCol = col;
+    } else if (event->button() == Qt::RightButton && m_board.toggleFlag(row, col)) {
+        update(cellRect(row, col));
+        emit progressChanged(m_board.revealedCount(), m_board.flaggedCount());
+    }
+}
+
+void EndlessView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::MiddleButton && m_panning) {
+        m_panning = false;
+        unsetCursor();
+        return;
+    }
+    if (event->button() != Qt::LeftButton || !m_pressed) {
+        return;
+    }
+
+    m_pressed = false;
+    int row, col;
+    if (cellAt(mousePos(event), &row, &col) && row == m_pressedRow && col == m_pressedCol) {
+        Trace::beginInteraction("endless_reveal");
+        afterChange(m_board.revealCell(row, col));
+    }
+}
+
+void EndlessView::mouseMoveEvent(QMouseEvent *event)
+{
+    const QPoint pos = mousePos(event);
+    if (m_panning) {
+        const QPoint delta = pos - m_panLast;
+        m_panLast = pos;
+        scrollBy(-delta.x(), -delta.y());
+        return;
+    }
+
+    int row = 0;
+    int col = 0;
+    const bool onCell = cellAt(pos, &row, &col);
+    if (onCell == m_hover && row == m_hoverRow && col == m_hoverCol) {
+        return;
+    }
+    if (m_hover) {
+        update(cellRect(m_hoverRow, m_hoverCol));
+    }
+    m_hover = onCell;
+    m_hoverRow = row;
+    m_hoverCol = col;
+    if (m_hover) {
+        update(cellRect(m_hoverRow, m_hoverCol));
+    }
+}
+
+void EndlessView::leaveEvent(QEvent *event)
+{
+    if (m_hover) {
+        m_hover = false;
+        update(cellRect(m_hoverRow, m_hoverCol));
+    }
+    QWidget::leaveEvent(event);
+}
+
+void EndlessView::wheelEvent(QWheelEvent *event)
+{
+    const QPoint delta = event->angleDelta();
+    if (event->modifiers() & Qt::ControlModifier) {
+        // Ctrl+滚轮以鼠标位置为中心缩放
+        if (delta.y() > 0) {
+            setCellSize(qMax(m_cellSize + 1, m_cellSize * 5 / 4), wheelPos(event));
+        } else if (delta.y() < 0) {
+            setCellSize(qMin(m_cellSize - 1, m_cellSize * 4 / 5), wheelPos(event));
+        }
+    } else {
+        // 一格滚轮（120）移动三个单元格，Shift 改为横向
+        const qint64 dx = qint64(-delta.x()) * 3 * m_cellSize / 120;
+        const qint64 dy = qint64(-delta.y()) * 3 * m_cellSize / 120;
+        if (event->modifiers() & Qt::ShiftModifier) {
+            scrollBy(dy, dx);
+        } else {
+            scrollBy(dx, dy);
+        }
+    }
+    event->accept();
+}
+
+void EndlessView::keyPressEvent(QKeyEvent *event)
+{
+    // 方向键每次移动四分之一个视口
+    const qint64 stepX = qMax(m_cellSize, width() / 4);
+    const qint64 stepY = qMax(m_cellSize, height() / 4);
+    switch (event->key()) {
+    case Qt::Key_Left:
+        scrollBy(-stepX, 0);
+        break;
+    case Qt::Key_Right:
+        scrollBy(stepX, 0);
+        break;
+    case Qt::Key_Up:
+        scrollBy(0, -stepY);
+        break;
+    case Qt::Key_Down:
+        scrollBy(0, stepY);
+        break;
+    default:
+        QWidget::keyPressEvent(event);
+    }
+}
@@ -0,0 +1,77 @@
+#ifndef ENDLESSVIEW_H
+#define ENDLESSVIEW_H
+
+#include <QWidget>
+#include <QTimer>
+#include "chunkedboard.h"
+#include "tileatlas.h"
+
+// 无尽模式的视图：在无边界的 ChunkedBoard 上开一个视口。
+// 中键拖动、滚轮和方向键平移，Ctrl+滚轮缩放；
+// 视口中心跨过块边界时压缩远处已解开的块，内存只随探索过的区域增长。
+// 超过 ChunkedBoard::MaxCascade 的展开在之后的事件循环里分批继续
+class EndlessView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit EndlessView(QWidget *parent = nullptr);
+
+    // 以新的种子开始，视口回到原点
+    void newGame(std::uint64_t seed, double density);
+
+    const ChunkedBoard &board() const { return m_board; }
+
+    QSize sizeHint() const override;
+
+signals:
+    // 揭开格数或标记数变化
+    void progressChanged(long long revealed, long long flagged);
+    void gameOver();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+
+private slots:
+    void continueCascade();
+
+private:
+    ChunkedBoard m_board;
+    TileAtlas m_atlas;
+    QTimer *m_cascadeTimer = nullptr;
+
+    // 视口左上角的世界像素坐标，行列可以为负
+    qint64 m_viewX = 0;
+    qint64 m_viewY = 0;
+    int m_cellSize = 30;
+
+    // 上次压缩时视口中心所在的块
+    int m_compactChunkRow = 0;
+    int m_compactChunkCol = 0;
+
+    // 鼠标状态
+    int m_hoverRow = 0;
+    int m_hoverCol = 0;
+    bool m_hover = false;
+    bool m_pressed = false;
+    int m_pressedRow = 0;
+    int m_pressedCol = 0;
+    bool m_panning = false;
+    QPoint m_panLast;
+
+    bool cellAt(const QPoint &pos, int *row, int *col) const;
+    QRect cellRect(int row, int col) const;
+    void scrollBy(qint64 dx, qint64 dy);
+    void setCellSize(int cellSize, const QPoint &anchor);
+    void compactAroundView();
+    void afterChange(const std::vector<ChunkedBoard::CellPos> &cells);
+};
+
+#endif // ENDLESSVIEW_H
@@ -1,22 +1,52 @@
 #include "gameboard.h"
-#include <QRandomGenerator>
 #include <QMessageBox>
 #include <QFileDialog>
+#include <QFile>
 #include <QDateTime>
 #include "debugwindow.h"
+#include "boardview.h"
+#include "rng.h"
+#include "trace.h"
+
+namespace {
+
+const int CascadeSliceMs = 4;       // 每轮事件循环的展开时间预算
+const int CascadeBatch = 512;       // 两次检查时间之间展开的单元格数
+const int AnimationIntervalMs = 16; // 动画模式下每帧展开一层
+
+} // namespace
 
 GameBoard::GameBoard(QWidget *parent) : QWidget(parent)
 {
-    // 初始化布局
-    m_gridLayout = new QGridLayout(this);
-    m_gridLayout->setSpacing(1);
-    setLayout(m_gridLayout);
+    // 初始化布局和游戏板视图
+    m_layout = new QVBoxLayout(this);
+    m_boardView = new BoardView(this);
+    m_boardView->setEngine(&m_engine);
+    m_layout->addWidget(m_boardView);
+    setLayout(m_layout);
+    
+    connect(m_boardView, &BoardView::cellClicked, this, &GameBoard::onCellClicked);
+    connect(m_boardView, &BoardView::cellRightClicked, this, &GameBoard::onCellRightClicked);
     
     // 初始化计时器
     m_timer = new QTimer(this);
     connect(m_timer, &QTimer::timeout, this, &GameBoard::updateTimerDisplay);
     m_timeOffset = 0;
     
+    // 初始化分时展开的定时器
+    m_cascadeTimer = new QTimer(this);
+    m_cascadeTimer->setSingleShot(true);
+    connect(m_cascadeTimer, &QTimer::timeout, this, &GameBoard::runCascadeSlice);
+    
+    // 初始化录像回放的定时器
+    m_replayTimer = new QTimer(this);
+    m_replayTimer->setSingleShot(true);
+    connect(m_replayTimer, &QTimer::timeout, this, &GameBoard::runReplay);
+    
+    // 初始化提示服务
+    m_hintService = new HintService(this);
+    connect(m_hintService, &HintService::hintReady, this, &GameBoard::onHintReady);
+    
     // 确保小部件可以接收键盘焦点
     setFocusPolicy(Qt::StrongFocus);
     
@@ -35,321 +65,509 @@ GameBoard::~GameBoard()
 
 void GameBoard::initializeBoard(int rows, int cols, int mineCount)
 {
-    // 清除旧的游戏板
-    resetGame();
+    resetBoard(rows, cols, mineCount);
     
-    // 设置新的游戏参数
-    m_rows = rows;
-    m_cols = cols;
-    m_mineCount = mineCount;
-    m_flaggedCount = 0;
-    m_firstClick = true;
-    m_gameOver = false;
-    m_gameWon = false;
-    
-    // 创建单元格
-    m_cells.resize(rows);
-    for (int row = 0; row < rows; ++row) {
-        m_cells[row].resize(cols);
-        for (int col = 0; col < cols; ++col) {
-            Cell *cell = new Cell(this);
-            m_cells[row][col] = cell;
-            
-            // 连接信号和槽
-            connect(cell, &QPushButton::clicked, this, &GameBoard::onCellClicked);
-            connect(cell, &QPushButton::customContextMenuRequested, this, &GameBoard::onCellRightClicked);
-            
-            // 添加到布局
-            m_gridLayout->addWidget(cell, row, col);
-        }
+    // 玩家游戏期间在后台准备同样参数的棋盘；棋盘库已经提供了棋盘时不需要
+    if (!loadCorpusBoard()) {
+        m_prefetcher.prefetch(prefetchKey());
     }
-    
-    // 计算合适的窗口大小
-    int cellSize = 30; // 默认单元格大小
-    int minWidth = cols * cellSize;
-    int minHeight = rows * cellSize;
-    setMinimumSize(minWidth, minHeight);
-    
-    // 发出信号更新地雷计数器
-    emit updateMineCounter(m_mineCount);
 }
 
-void GameBoard::resetGame()
+void GameBoard::resetBoard(int rows, int cols, int mineCount)
 {
-    // 停止计时器
+    // 停止计时器，取消进行中的展开（引擎重置时丢弃展开队列）
     m_timer->stop();
-    
-    // 清除旧的单元格
-    for (auto &row : m_cells) {
-        for (auto cell : row) {
-            if (cell) {
-                m_gridLayout->removeWidget(cell);
-                delete cell;
-            }
-        }
-    }
-    m_cells.clear();
-    
-    // 重置游戏状态
-    m_firstClick = true;
-    m_gameOver = false;
-    m_gameWon = false;
-    m_flaggedCount = 0;
+    m_cascadeTimer->stop();
+    m_hintService->cancel();
+    stopReplay();
     
     // 关闭Debug窗口（如果存在）
     if (m_debugWindow && m_debugWindow->isVisible()) {
         m_debugWindow->close();
     }
     
-    // 发出信号更新计数器
-    emit updateMineCounter(m_mineCount);
+    // 设置新的游戏参数，尺寸不变时引擎和视图都原地复用已有内存；
+    // 视图可以滚动和缩放，不再按棋盘大小限制最小尺寸
+    m_mineCountSetting = mineCount;
+    m_engine.reset(rows, cols, mineCount);
+    m_firstClick = true;
+    m_boardView->resetView();
+    m_elapsedTime.invalidate();
+    m_timeOffset = 0;
+    m_replay.begin(rows, cols, mineCount);
+    m_undo.clear();
+    
+    // 计数器随变更通知更新，计时器立即归零
+    scheduleChanges();
     emit updateTimer(0);
 }
 
-void GameBoard::placeMines(int firstRow, int firstCol)
+bool GameBoard::loadCorpusBoard()
 {
-    // 确保第一次点击的位置及其周围没有地雷
-    QVector<QPair<int, int>> safeCells;
-    for (int r = firstRow - 1; r <= firstRow + 1; ++r) {
-        for (int c = firstCol - 1; c <= firstCol + 1; ++c) {
-            if (isValidCell(r, c)) {
-                safeCells.append(qMakePair(r, c));
-            }
-        }
+    BoardCorpus::Query query;
+    query.rows = m_engine.rows();
+    query.cols = m_engine.cols();
+    query.mines = m_mineCountSetting;
+    BoardCorpus::Board board;
+    // 棋盘库不记录棋盘是否经过无猜验证，无猜模式不从库中取题
+    if (m_noGuess || !m_corpus.isOpen() || !m_corpus.pick(query, threadLocalRandom(), &board)) {
+        return false;
     }
     
-    // 随机放置地雷
-    int minesPlaced = 0;
-    while (minesPlaced < m_mineCount) {
-        int row = QRandomGenerator::global()->bounded(m_rows);
-        int col = QRandomGenerator::global()->bounded(m_cols);
-        
-        // 检查是否是安全区域
-        bool isSafeCell = false;
-        for (const auto &safeCell : safeCells) {
-            if (safeCell.first == row && safeCell.second == col) {
-                isSafeCell = true;
-                break;
-            }
-        }
-        
-        // 如果不是安全区域且没有地雷，则放置地雷
-        if (!isSafeCell && !m_cells[row][col]->isMine()) {
-            m_cells[row][col]->setMine(true);
-            minesPlaced++;
-        }
-    }
-    
-    // 计算每个单元格周围的地雷数量
-    calculateAdjacentMines();
+    // 直接放入库中的布局，不调用 placeMines；开局区域由棋盘库给定，
+    // 在录像里记为第0毫秒的一次点击。回放时这次点击和其他揭开一样进入撤销历史，
+    // 这里也作为可撤销的一步记录，两边的历史保持一致
+    BoardCorpus::load(board, &m_engine);
+    m_replay.setMineLayout(m_engine);
+    m_firstClick = false;
+    recordAction(Replay::Reveal, board.openRow, board.openCol);
+    m_undo.begin(m_engine);
+    m_engine.beginReveal(board.openRow, board.openCol);
+    runCascadeSlice();
+    return true;
 }
 
-void GameBoard::calculateAdjacentMines()
+bool GameBoard::openCorpus(const QString &fileName)
 {
-    for (int row = 0; row < m_rows; ++row) {
-        for (int col = 0; col < m_cols; ++col) {
-            if (!m_cells[row][col]->isMine()) {
-                int count = 0;
-                
-                // 检查周围8个方向的单元格
-                for (int r = row - 1; r <= row + 1; ++r) {
-                    for (int c = col - 1; c <= col + 1; ++c) {
-                        if (isValidCell(r, c) && m_cells[r][c]->isMine()) {
-                            count++;
-                        }
-                    }
-                }
-                
-                m_cells[row][col]->setAdjacentMines(count);
-            }
-        }
-    }
+    return m_corpus.open(QFile::encodeName(fileName).toStdString());
 }
 
-void GameBoard::onCellClicked()
+void GameBoard::closeCorpus()
 {
-    // 获取被点击的单元格
-    Cell *cell = qobject_cast<Cell*>(sender());
-    if (!cell || m_gameOver) {
+    m_corpus.close();
+}
+
+void GameBoard::setNoGuess(bool noGuess)
+{
+    m_noGuess = noGuess;
+    m_prefetcher.prefetch(prefetchKey());
+}
+
+BoardPrefetcher::Key GameBoard::prefetchKey() const
+{
+    return {m_engine.rows(), m_engine.cols(), m_mineCountSetting,
+            m_noGuess ? BoardPrefetcher::NoGuess : BoardPrefetcher::Standard};
+}
+
+NoGuessGenerator::Stats GameBoard::noGuessStats() const
+{
+    // 合并后台预生成和首次点击时同步生成的统计
+    NoGuessGenerator::Stats stats = m_prefetcher.generatorStats(
+        {m_engine.rows(), m_engine.cols(), m_mineCountSetting, BoardPrefetcher::NoGuess});
+    const NoGuessGenerator::Stats direct =
+        m_noGuessGenerator.stats(m_engine.rows(), m_engine.cols(), m_mineCountSetting);
+    stats.boards += direct.boards;
+    stats.candidates += direct.candidates;
+    stats.failures += direct.failures;
+    stats.totalMs += direct.totalMs;
+    return stats;
+}
+
+void GameBoard::resetGame()
+{
+    // 以相同的参数重新开始
+    initializeBoard(m_engine.rows(), m_engine.cols(), m_mineCountSetting);
+}
+
+void GameBoard::onCellClicked(int row, int col)
+{
+    TRACE_SPAN("GameBoard::onCellClicked");
+    if (isReplaying()) {
         return;
     }
     
-    // 找到单元格的位置
-    int row = -1, col = -1;
-    for (int r = 0; r < m_rows; ++r) {
-        for (int c = 0; c < m_cols; ++c) {
-            if (m_cells[r][c] == cell) {
-                row = r;
-                col = c;
-                break;
-            }
+    // 任何一步都会让进行中的提示过期
+    cancelHint();
+    
+    // 上一次的展开还没结束时先立即完成它
+    finishCascade();
+    if (m_engine.isGameOver()) {
+        return;
+    }
+    
+    // 点击已揭开的数字：周围标记数与数字相符时揭开其余的邻格
+    if (m_engine.isRevealed(row, col)) {
+        m_undo.begin(m_engine);
+        if (m_engine.beginChord(row, col) || m_engine.isGameOver()) {
+            Trace::beginInteraction("chord");
+            startClock();
+            recordAction(Replay::Chord, row, col);
+            runCascadeSlice();
+        } else {
+            m_undo.commit(m_engine);
         }
-        if (row != -1) break;
+        return;
     }
     
-    // 如果单元格已标记或已揭示，则不做任何操作
-    if (cell->isFlagged() || cell->isRevealed()) {
+    // 如果单元格已标记，则不做任何操作
+    if (m_engine.isFlagged(row, col)) {
         return;
     }
+    Trace::beginInteraction(m_firstClick ? "first_click" : "reveal");
     
-    // 如果是第一次点击，放置地雷并开始计时
+    // 如果是第一次点击，放置地雷
     if (m_firstClick) {
-        placeMines(row, col);
+        // 优先把预生成的棋盘整体移入引擎；开局前插的旗会随引擎一起被替换，这时不取用
+        if (m_engine.flaggedCount() == 0 && m_prefetcher.take(prefetchKey(), row, col, &m_engine)) {
+            // 预生成的棋盘经过重新锚定，种子无法复现，录像保存完整布局；
+            // 引擎已被整体替换，开局前的撤销历史不再适用
+            m_replay.setMineLayout(m_engine);
+            m_undo.clear();
+            m_solver.rebuild();
+        } else {
+            // 无猜模式从随机的基础种子开始寻找，找不到时退回普通棋盘（seed 为第一个候选）
+            std::uint64_t seed = threadLocalRandom();
+            if (m_noGuess) {
+                m_noGuessGenerator.generate(m_engine.rows(), m_engine.cols(), m_mineCountSetting, row, col,
+                                            seed, &seed);
+            }
+            m_engine.placeMines(row, col, seed);
+            m_replay.setSeed(row, col, seed);
+        }
         m_firstClick = false;
-        m_elapsedTime.start();
-        m_timer->start(1000); // 每秒更新一次
     }
+    startClock();
     
-    // 揭示单元格
-    revealCell(row, col);
-    
-    // 更新Debug窗口
-    if (m_debugWindow && m_debugWindow->isVisible()) {
-        m_debugWindow->updateDisplay();
-    }
+    // 揭示单元格，大面积展开分多轮事件循环完成，展开结束后才记入撤销历史
+    recordAction(Replay::Reveal, row, col);
+    m_undo.begin(m_engine);
+    m_engine.beginReveal(row, col);
+    runCascadeSlice();
 }
 
-void GameBoard::onCellRightClicked()
+void GameBoard::onCellRightClicked(int row, int col)
 {
-    // 获取被右键点击的单元格
-    Cell *cell = qobject_cast<Cell*>(sender());
-    if (!cell || m_gameOver) {
+    TRACE_SPAN("GameBoard::onCellRightClicked");
+    if (isReplaying()) {
         return;
     }
-    
-    // 如果单元格已揭示，则不做任何操作
-    if (cell->isRevealed()) {
+    cancelHint();
+    finishCascade();
+    if (m_engine.isGameOver()) {
         return;
     }
     
-    // 切换标记状态
-    bool flagged = cell->isFlagged();
-    cell->setFlagged(!flagged);
-    cell->updateAppearance();
-    
-    // 更新标记计数
-    m_flaggedCount += flagged ? -1 : 1;
-    emit updateMineCounter(m_mineCount - m_flaggedCount);
-    
-    // 更新Debug窗口
-    if (m_debugWindow && m_debugWindow->isVisible()) {
-        m_debugWindow->updateDisplay();
+    // 切换标记状态（已揭示的单元格不做任何操作）
+    m_undo.begin(m_engine);
+    const bool toggled = m_engine.toggleFlag(row, col);
+    m_undo.commit(m_engine);
+    if (toggled) {
+        Trace::beginInteraction("flag");
+        if (!m_firstClick) {
+            startClock();
+        }
+        recordAction(Replay::Flag, row, col);
+        scheduleChanges();
     }
 }
 
-void GameBoard::revealCell(int row, int col)
+void GameBoard::undo()
 {
-    // 检查单元格是否有效
-    if (!isValidCell(row, col)) {
+    TRACE_SPAN("GameBoard::undo");
+    if (isReplaying()) {
         return;
     }
-    
-    Cell *cell = m_cells[row][col];
-    
-    // 如果单元格已揭示或已标记，则不做任何操作
-    if (cell->isRevealed() || cell->isFlagged()) {
+    cancelHint();
+    finishCascade();
+    const bool wasGameOver = m_engine.isGameOver();
+    if (m_undo.undo(m_engine)) {
+        m_replay.append(gameTime(), Replay::Undo, 0);
+        afterHistoryStep(wasGameOver);
+    }
+}
+
+void GameBoard::redo()
+{
+    TRACE_SPAN("GameBoard::redo");
+    if (isReplaying()) {
         return;
     }
-    
-    // 揭示单元格
-    cell->setRevealed(true);
-    cell->updateAppearance();
-    
-    // 如果是地雷，游戏结束
-    if (cell->isMine()) {
-        // 显示所有地雷
-        for (int r = 0; r < m_rows; ++r) {
-            for (int c = 0; c < m_cols; ++c) {
-                if (m_cells[r][c]->isMine()) {
-                    m_cells[r][c]->setRevealed(true);
-                    m_cells[r][c]->updateAppearance();
-                }
-            }
-        }
-        
-        m_gameOver = true;
-        m_timer->stop();
-        
-        // 如果Debug窗口打开，关闭它
-        if (m_debugWindow && m_debugWindow->isVisible()) {
-            m_debugWindow->close();
+    cancelHint();
+    finishCascade();
+    const bool wasGameOver = m_engine.isGameOver();
+    if (m_undo.redo(m_engine)) {
+        m_replay.append(gameTime(), Replay::Redo, 0);
+        afterHistoryStep(wasGameOver);
+    }
+}
+
+void GameBoard::afterHistoryStep(bool wasGameOver)
+{
+    // 撤销回到进行中的对局时计时继续（结束后经过的时间也计入），重做到结束时照常结算
+    scheduleChanges();
+    if (wasGameOver && !m_engine.isGameOver()) {
+        if (m_elapsedTime.isValid()) {
+            m_timer->start(1000);
         }
-        
-        emit gameOver(false);
+    } else if (!wasGameOver && m_engine.isGameOver()) {
+        handleGameEnd();
     }
-    // 如果是空白单元格（周围没有地雷），自动揭示周围的单元格
-    else if (cell->adjacentMines() == 0) {
-        revealAdjacentCells(row, col);
+}
+
+void GameBoard::requestHint()
+{
+    // 开局前、结束后和回放期间没有可提示的内容
+    if (m_firstClick || m_engine.isGameOver() || isReplaying()) {
+        return;
     }
-    
-    // 检查是否赢得游戏
-    checkGameWon();
+    finishCascade();
+    m_boardView->clearHint();
+    // 先把尚未发布的变化交给求解器，提示使用的前沿与快照一致
+    publishChanges();
+    m_hintService->request(m_engine, m_solver.frontier());
 }
 
-void GameBoard::revealAdjacentCells(int row, int col)
+void GameBoard::cancelHint()
 {
-    // 揭示周围8个方向的单元格
-    for (int r = row - 1; r <= row + 1; ++r) {
-        for (int c = col - 1; c <= col + 1; ++c) {
-            if (r != row || c != col) { // 跳过当前单元格
-                revealCell(r, c);
-            }
-        }
+    m_hintService->cancel();
+    m_boardView->clearHint();
+}
+
+void GameBoard::onHintReady(const HintService::Hint &hint)
+{
+    if (hint.row >= 0) {
+        m_boardView->setHintCell(hint.row, hint.col, hint.safe);
     }
 }
 
-void GameBoard::checkGameWon()
+void GameBoard::runCascadeSlice()
 {
-    // 检查是否所有非地雷单元格都已揭示
-    for (int row = 0; row < m_rows; ++row) {
-        for (int col = 0; col < m_cols; ++col) {
-            Cell *cell = m_cells[row][col];
-            if (!cell->isMine() && !cell->isRevealed()) {
-                return; // 还有非地雷单元格未揭示，游戏未结束
-            }
+    TRACE_SPAN("GameBoard::runCascadeSlice");
+    QElapsedTimer slice;
+    slice.start();
+    
+    if (m_animateCascade) {
+        // 每帧展开当前排队的一整层，形成向外扩散的波前
+        m_engine.continueReveal(m_engine.pendingRevealCells());
+    } else {
+        while (!m_engine.continueReveal(CascadeBatch) && slice.elapsed() < CascadeSliceMs) {
         }
     }
+    scheduleChanges();
     
-    // 所有非地雷单元格都已揭示，游戏胜利
-    m_gameOver = true;
-    m_gameWon = true;
-    m_timer->stop();
+    if (m_engine.isRevealPending()) {
+        m_cascadeTimer->start(m_animateCascade ? AnimationIntervalMs : 0);
+        return;
+    }
+    afterReveal();
+}
+
+void GameBoard::scheduleChanges()
+{
+    // 同一轮事件循环内的多次操作合并为一次通知
+    if (!m_changesScheduled) {
+        m_changesScheduled = true;
+        QTimer::singleShot(0, this, &GameBoard::publishChanges);
+    }
+}
+
+void GameBoard::publishChanges()
+{
+    TRACE_SPAN("GameBoard::publishChanges");
+    m_changesScheduled = false;
+    const BoardEngine::ChangeSet &changes = m_engine.changes();
+    if (changes.empty()) {
+        return;
+    }
     
-    // 标记所有地雷
-    for (int row = 0; row < m_rows; ++row) {
-        for (int col = 0; col < m_cols; ++col) {
-            Cell *cell = m_cells[row][col];
-            if (cell->isMine() && !cell->isFlagged()) {
-                cell->setFlagged(true);
-                cell->updateAppearance();
-                m_flaggedCount++;
-            }
+    m_solver.update(changes);
+    m_boardView->applyChanges(changes);
+    if (m_debugWindow && m_debugWindow->isVisible()) {
+        // 热图打开时整幅重画，否则只改写变化的像素
+        if (m_debugWindow->heatmapEnabled()) {
+            updateHeatmap();
+        } else {
+            m_debugWindow->applyChanges(changes);
         }
     }
+    if (changes.fullUpdate || changes.flaggedDelta || changes.mineCountDelta) {
+        emit updateMineCounter(m_engine.remainingMines());
+    }
+    emit cellsChanged(changes);
+    m_engine.clearChanges();
+}
+
+void GameBoard::finishCascade()
+{
+    if (!m_engine.isRevealPending()) {
+        return;
+    }
+    m_cascadeTimer->stop();
+    m_engine.finishReveal();
+    scheduleChanges();
+    afterReveal();
+}
+
+void GameBoard::afterReveal()
+{
+    // 整个展开作为一步记入撤销历史（没有开始记录时什么也不做）
+    m_undo.commit(m_engine);
+    if (m_engine.isGameOver()) {
+        handleGameEnd();
+    }
+}
+
+void GameBoard::handleGameEnd()
+{
+    m_timer->stop();
     
     // 如果Debug窗口打开，关闭它
     if (m_debugWindow && m_debugWindow->isVisible()) {
         m_debugWindow->close();
     }
     
-    emit updateMineCounter(0);
-    emit gameOver(true);
+    // 游戏结束对话框弹出前先把最后的变化画到棋盘上
+    publishChanges();
+    emit gameOver(m_engine.isGameWon());
 }
 
 void GameBoard::updateTimerDisplay()
 {
-    emit updateTimer((m_elapsedTime.elapsed() + m_timeOffset) / 1000);
+    emit updateTimer(gameTime() / 1000);
 }
 
-bool GameBoard::isValidCell(int row, int col) const
+void GameBoard::startClock()
 {
-    return row >= 0 && row < m_rows && col >= 0 && col < m_cols;
+    // 计时从玩家的第一步开始；棋盘库的棋盘在开局时就已布雷，开局区域也已揭开
+    if (!m_elapsedTime.isValid()) {
+        m_elapsedTime.start();
+        m_timer->start(1000); // 每秒更新一次
+    }
+}
+
+qint64 GameBoard::gameTime() const
+{
+    // 首次点击之前计时器尚未启动
+    return m_elapsedTime.isValid() ? m_elapsedTime.elapsed() + m_timeOffset : m_timeOffset;
+}
+
+void GameBoard::recordAction(Replay::Action action, int row, int col)
+{
+    m_replay.append(gameTime(), action, m_engine.indexOf(row, col));
+}
+
+void GameBoard::playReplay(const Replay &replay, double speed)
+{
+    // 先复制：replay 可能就是 m_replay，重置棋盘时会被清空
+    m_playback = replay;
+    resetBoard(m_playback.rows(), m_playback.cols(), m_playback.mineCount());
+    m_playback.setupBoard(m_engine);
+    m_firstClick = !m_engine.minesPlaced();
+    scheduleChanges();
+    
+    m_replaySpeed = qBound(1.0, speed, 100.0);
+    m_replayReader.reset(new Replay::Reader(m_playback));
+    m_hasNextRecord = m_replayReader->next(&m_nextRecord);
+    m_replayClock.start();
+    runReplay();
+}
+
+void GameBoard::stopReplay()
+{
+    m_replayTimer->stop();
+    m_replayReader.reset();
+    m_hasNextRecord = false;
+}
+
+void GameBoard::runReplay()
+{
+    // 执行所有已经到时间的动作，再按下一条记录的时间差定时
+    const qint64 now = static_cast<qint64>(m_replayClock.elapsed() * m_replaySpeed);
+    qint64 tick = 0;
+    // 对局结束后录像里还可能有撤销，所以一直执行到最后一条记录
+    while (m_hasNextRecord && m_nextRecord.tick <= now) {
+        tick = m_nextRecord.tick;
+        Replay::apply(m_engine, m_undo, m_nextRecord);
+        m_hasNextRecord = m_replayReader->next(&m_nextRecord);
+    }
+    scheduleChanges();
+    emit updateTimer(qMax(tick, now) / 1000);
+    
+    if (m_hasNextRecord) {
+        const double wait = (m_nextRecord.tick - now) / m_replaySpeed;
+        m_replayTimer->start(qMax(0, static_cast<int>(wait)));
+        return;
+    }
+    
+    // 回放完毕：录像从这里继续，玩家可以接着玩
+    stopReplay();
+    m_replay = m_playback;
+    m_timeOffset = tick;
+    if (m_engine.isGameOver()) {
+        handleGameEnd();
+    } else if (!m_firstClick) {
+        m_elapsedTime.start();
+        m_timer->start(1000);
+    }
+}
+
+bool GameBoard::saveGame(const QString &fileName)
+{
+    if (isReplaying()) {
+        return false;
+    }
+    finishCascade();
+    
+    GameSnapshot::Info info;
+    info.mineCountSetting = m_mineCountSetting;
+    info.elapsedMs = gameTime();
+    const std::vector<std::uint8_t> data = GameSnapshot::save(m_engine, info, m_replay);
+    
+    // 存档已在内存中拼好，不经过 QFile 的缓冲区一次写入
+    QFile file(fileName);
+    return file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Unbuffered)
+        && file.write(reinterpret_cast<const char *>(data.data()), static_cast<qint64>(data.size()))
+               == static_cast<qint64>(data.size());
+}
+
+bool GameBoard::loadGame(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly) || file.size() <= 0) {
+        return false;
+    }
+    // 位平面和可见状态直接从映射的页面读入引擎，文件关闭时解除映射
+    const uchar *data = file.map(0, file.size());
+    Replay replay;
+    GameSnapshot::Info info;
+    if (!data || !GameSnapshot::load(data, static_cast<std::size_t>(file.size()), &m_engine, &info, &replay)) {
+        return false;
+    }
+    
+    // 引擎已被替换：丢弃旧对局的展开、提示和回放
+    m_timer->stop();
+    m_cascadeTimer->stop();
+    m_hintService->cancel();
+    stopReplay();
+    if (m_debugWindow && m_debugWindow->isVisible()) {
+        m_debugWindow->close();
+    }
+    
+    m_mineCountSetting = info.mineCountSetting;
+    m_firstClick = !m_engine.minesPlaced();
+    m_replay = std::move(replay);
+    m_undo.clear();
+    m_solver.rebuild();
+    m_boardView->resetView();
+    scheduleChanges();
+    
+    // 计时从存档的时间继续
+    m_elapsedTime.invalidate();
+    m_timeOffset = info.elapsedMs;
+    emit updateTimer(static_cast<int>(m_timeOffset / 1000));
+    if (!m_firstClick && !m_engine.isGameOver()) {
+        m_elapsedTime.start();
+        m_timer->start(1000);
+    }
+    
+    m_prefetcher.prefetch(prefetchKey());
+    return true;
 }
 
 bool GameBoard::isMineAt(int row, int col) const
 {
-    if (isValidCell(row, col)) {
-        return m_cells[row][col]->isMine();
+    if (m_engine.isValidCell(row, col)) {
+        return m_engine.isMine(row, col);
     }
     return false;
 }
@@ -393,7 +611,15 @@ void GameBoard::toggleDebugWindow()
         m_debugWindow->hide();
     } else {
         if (!m_debugWindow) {
-            m_debugWindow = new DebugWindow(this);
+            m_debugWindow = new DebugWindow(&m_engine);
+            connect(m_debugWindow, &DebugWindow::heatmapToggled, this, [this](bool enabled) {
+                if (enabled) {
+                    updateHeatmap();
+                }
+            });
+        } else if (m_debugWindow->heatmapEnabled()) {
+            // 隐藏期间没有计算概率
+            updateHeatmap();
         } else {
             // 确保窗口显示最新数据
             m_debugWindow->updateDisplay();
@@ -404,3 +630,16 @@ void GameBoard::toggleDebugWindow()
     }
 }
 
+void GameBoard::updateHeatmap()
+{
+    TRACE_SPAN("GameBoard::updateHeatmap");
+    // 求解器的前沿随每次变更增量维护，开销只与前沿有关；分量结果跨步缓存。
+    // 超出枚举预算的分量给出近似值，调试用途足够
+    m_solver.solve();
+    const ProbabilityEngine::Result &result = m_heatmapEngine.compute(m_engine, m_solver.constraints());
+    if (result.cancelled) {
+        return;
+    }
+    m_heatmapEngine.fillBoard(m_engine, &m_heatmap);
+    m_debugWindow->setProbabilities(m_heatmap);
+}
@@ -2,14 +2,24 @@
 #define GAMEBOARD_H
 
 #include <QWidget>
-#include <QGridLayout>
+#include <QVBoxLayout>
 #include <QVector>
 #include <QTimer>
 #include <QElapsedTimer>
 #include <QKeyEvent>
-#include "cell.h"
+#include <memory>
+#include "boardengine.h"
+#include "solver.h"
+#include "hintservice.h"
+#include "noguess.h"
+#include "boardprefetcher.h"
+#include "boardcorpus.h"
+#include "replay.h"
+#include "snapshot.h"
+#include "undolog.h"
 
 class DebugWindow;
+class BoardView;
 
 class GameBoard : public QWidget
 {
@@ -19,24 +29,75 @@ public:
     explicit GameBoard(QWidget *parent = nullptr);
     ~GameBoard();
     
-    // 初始化游戏板
+    // 初始化游戏板，尺寸与当前相同时原地重置
     void initializeBoard(int rows, int cols, int mineCount);
     
-    // 重置游戏
+    // 以当前参数重置游戏
     void resetGame();
     
     // 获取游戏状态
-    bool isGameOver() const { return m_gameOver; }
-    bool isGameWon() const { return m_gameWon; }
-    int remainingMines() const { return m_mineCount - m_flaggedCount; }
-    int elapsedSeconds() const { return m_elapsedTime.elapsed() / 1000; }
+    bool isGameOver() const { return m_engine.isGameOver(); }
+    bool isGameWon() const { return m_engine.isGameWon(); }
+    int remainingMines() const { return m_engine.remainingMines(); }
+    int elapsedSeconds() const { return static_cast<int>(gameTime() / 1000); }
     
     // 获取地雷位置信息
-    int getRows() const { return m_rows; }
-    int getCols() const { return m_cols; }
+    int getRows() const { return m_engine.rows(); }
+    int getCols() const { return m_engine.cols(); }
     bool isMineAt(int row, int col) const;
     
+    // 底层游戏引擎
+    const BoardEngine &engine() const { return m_engine; }
+    
+    // 随每次变更增量维护前沿的求解器，只使用玩家可见的信息
+    Solver &solver() { return m_solver; }
+    
+    // 大面积展开时是否逐层播放扩散动画
+    void setAnimateCascade(bool animate) { m_animateCascade = animate; }
+    
+    // 无猜模式：首次点击时只发放求解器不需要猜测就能解开的棋盘
+    void setNoGuess(bool noGuess);
+    NoGuessGenerator::Stats noGuessStats() const;
+    
+    // 后台提示服务（可查询延迟统计）
+    const HintService *hintService() const { return m_hintService; }
+    
+    // 本局的录像，每一步操作都会追加
+    const Replay &replay() const { return m_replay; }
+    
+    // 以 speed 倍速回放录像，回放期间忽略玩家输入；
+    // 回放结束后可以接着这个局面继续玩，录像也随之继续
+    void playReplay(const Replay &replay, double speed);
+    void stopReplay();
+    bool isReplaying() const { return m_replayReader != nullptr; }
+    
+    // 存档和读档：进行中的对局（含计时和录像）保存为 GameSnapshot 格式，
+    // 读档时映射文件直接解析。回放期间不能存档；失败时当前对局不变
+    bool saveGame(const QString &fileName);
+    bool loadGame(const QString &fileName);
+    
+    // 棋盘库：打开后新对局优先从库中随机取尺寸和地雷数相同的棋盘，
+    // 开局区域直接揭开，计时从玩家的第一步开始；库中没有合适的棋盘时照常布雷
+    bool openCorpus(const QString &fileName);
+    void closeCorpus();
+    const BoardCorpus &corpus() const { return m_corpus; }
+    
+    // 撤销历史：布雷之后的每一步（揭开、标记、双击）可以撤销和重做，
+    // 布雷本身不会撤销。历史占用的内存不超过 bytes，超出时丢弃最旧的步骤
+    void setUndoMemoryLimit(std::size_t bytes) { m_undo.setCapacity(bytes); }
+    const UndoLog &undoLog() const { return m_undo; }
+    
+public slots:
+    // 在后台计算提示，完成后在棋盘上标出；玩家的下一步会取消它
+    void requestHint();
+    
+    // 撤销和重做也记入录像；撤销已结束对局的最后一步会让对局继续
+    void undo();
+    void redo();
+    
 signals:
+    // 每轮事件循环最多发出一次，合并了这一轮内所有操作的变化
+    void cellsChanged(const BoardEngine::ChangeSet &changes);
     void gameOver(bool won);
     void updateMineCounter(int count);
     void updateTimer(int seconds);
@@ -46,24 +107,60 @@ protected:
     void keyPressEvent(QKeyEvent *event) override;
     
 private slots:
-    void onCellClicked();
-    void onCellRightClicked();
+    void onCellClicked(int row, int col);
+    void onCellRightClicked(int row, int col);
     void updateTimerDisplay();
     void toggleDebugWindow();
+    void updateHeatmap();
+    void runCascadeSlice();
+    void publishChanges();
+    void onHintReady(const HintService::Hint &hint);
+    void runReplay();
     
 private:
-    // 游戏参数
-    int m_rows = 0;
-    int m_cols = 0;
-    int m_mineCount = 0;
-    int m_flaggedCount = 0;
+    // 游戏状态
+    BoardEngine m_engine;
+    Solver m_solver{m_engine};
+    int m_mineCountSetting = 0; // 玩家设置的地雷数，引擎可能在放置时减少
     bool m_firstClick = true;
-    bool m_gameOver = false;
-    bool m_gameWon = false;
     
-    // 布局和单元格
-    QGridLayout *m_gridLayout = nullptr;
-    QVector<QVector<Cell*>> m_cells;
+    // 布局和游戏板视图
+    QVBoxLayout *m_layout = nullptr;
+    BoardView *m_boardView = nullptr;
+    
+    // 分时展开：每轮事件循环最多展开几毫秒，保持界面响应
+    QTimer *m_cascadeTimer = nullptr;
+    bool m_animateCascade = false;
+    
+    // 无猜棋盘生成
+    bool m_noGuess = false;
+    NoGuessGenerator m_noGuessGenerator;
+    
+    // 后台预生成下一局的棋盘，首次点击时直接取用
+    BoardPrefetcher m_prefetcher;
+    BoardPrefetcher::Key prefetchKey() const;
+    
+    // 预生成的棋盘库（只读映射）
+    BoardCorpus m_corpus;
+    
+    // 提示
+    HintService *m_hintService = nullptr;
+    
+    // 录像：m_replay 记录本局，m_playback 是正在回放的录像
+    Replay m_replay;
+    Replay m_playback;
+    std::unique_ptr<Replay::Reader> m_replayReader;
+    Replay::Record m_nextRecord;
+    bool m_hasNextRecord = false;
+    double m_replaySpeed = 1.0;
+    QElapsedTimer m_replayClock;
+    QTimer *m_replayTimer = nullptr;
+    
+    // 撤销历史
+    UndoLog m_undo;
+    
+    // 变更通知已排入事件队列，同一轮内的后续操作不再重复排队
+    bool m_changesScheduled = false;
     
     // 计时器
     QTimer *m_timer = nullptr;
@@ -74,13 +171,24 @@ private:
     QVector<QDateTime> m_deleteKeyPresses;
     DebugWindow *m_debugWindow = nullptr;
     
-    // 游戏逻辑方法
-    void placeMines(int firstRow, int firstCol);
-    void calculateAdjacentMines();
-    void revealCell(int row, int col);
-    void revealAdjacentCells(int row, int col);
-    void checkGameWon();
-    bool isValidCell(int row, int col) const;
+    // 调试窗口的概率热图，在界面线程上用增量维护的求解器计算
+    ProbabilityEngine m_heatmapEngine;
+    std::vector<float> m_heatmap;
+    
+    // 重置为空白棋盘，不取棋盘库也不预生成（回放用）
+    void resetBoard(int rows, int cols, int mineCount);
+    
+    // 变更通知、展开进度和游戏结束处理
+    void scheduleChanges();
+    void cancelHint();
+    void finishCascade();
+    void afterReveal();
+    void handleGameEnd();
+    void afterHistoryStep(bool wasGameOver);
+    bool loadCorpusBoard();
+    void startClock();
+    qint64 gameTime() const;
+    void recordAction(Replay::Action action, int row, int col);
 };
 
 #endif // GAMEBOARD_H
\ No newline at end of file
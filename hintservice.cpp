@@ -0,0 +1,140 @@
+#include "hintservice.h"
+#include "solver.h"
+#include <QMetaObject>
+#include <algorithm>
+
+HintService::HintService(QObject *parent) : QObject(parent)
+{
+    // 概率引擎的分量枚举仍然并行使用全局线程池
+    m_latencies.reserve(LatencySamples);
+}
+
+HintService::~HintService()
+{
+    cancel();
+}
+
+void HintService::cancel()
+{
+    if (m_cancelFlag) {
+        m_cancelFlag->store(true);
+        m_cancelFlag.reset();
+    }
+    m_busy = false;
+}
+
+void HintService::request(const BoardEngine &engine, const std::vector<int> &frontier)
+{
+    cancel();
+
+    // 快照在工作线程上只读，界面线程之后对引擎的修改不会影响它
+    auto snapshot = std::make_shared<const BoardEngine>(engine);
+    auto frontierSnapshot = std::make_shared<const std::vector<int>>(frontier);
+    auto cancelFlag = std::make_shared<std::atomic<bool>>(false);
+    m_cancelFlag = cancelFlag;
+    m_busy = true;
+
+    QElapsedTimer latency;
+    latency.start();
+    m_worker.submit([this, snapshot, frontierSnapshot, cancelFlag, latency] {
+        if (cancelFlag->load()) {
+            return;
+        }
+        const Hint hint = computeHint(*snapshot, *frontierSnapshot, cancelFlag.get());
+        if (cancelFlag->load()) {
+            return;
+        }
+
+        QMetaObject::invokeMethod(this, [this, hint, cancelFlag, latency] {
+            // 排队期间玩家可能已经走了下一步
+            if (cancelFlag->load() || m_cancelFlag != cancelFlag) {
+                return;
+            }
+            m_cancelFlag.reset();
+            m_busy = false;
+            recordLatency(latency.nsecsElapsed() / 1e6);
+            emit hintReady(hint);
+        }, Qt::QueuedConnection);
+    });
+}
+
+HintService::Hint HintService::computeHint(const BoardEngine &snapshot, const std::vector<int> &frontier,
+                                          const std::atomic<bool> *cancel)
+{
+    Hint hint;
+    const int cols = snapshot.cols();
+
+    // 先找可以证明安全的单元格；前沿来自界面线程增量维护的求解器
+    Solver solver(snapshot);
+    solver.setFrontier(frontier);
+    const Solver::Result &solved = solver.solve();
+    if (!solved.safeCells.empty()) {
+        hint.row = solved.safeCells.front() / cols;
+        hint.col = solved.safeCells.front() % cols;
+        hint.safe = true;
+        hint.mineProbability = 0.0;
+        return hint;
+    }
+    if (cancel->load()) {
+        return hint;
+    }
+
+    // 没有确定安全的单元格时取概率最低的前沿格或内部格
+    m_probability.setCancelFlag(cancel);
+    const ProbabilityEngine::Result &result = m_probability.compute(snapshot, solver.constraints());
+    m_probability.setCancelFlag(nullptr);
+    if (result.cancelled) {
+        return hint;
+    }
+
+    int best = -1;
+    double bestProbability = 2.0;
+    for (size_t i = 0; i < result.cells.size(); ++i) {
+        if (result.probabilities[i] < bestProbability) {
+            bestProbability = result.probabilities[i];
+            best = result.cells[i];
+        }
+    }
+    if (result.interiorCells > 0 && result.interiorProbability < bestProbability) {
+        // 第一个不在前沿上的未知格
+        const std::vector<std::uint8_t> &cells = snapshot.cells();
+        for (int i = 0; i < snapshot.cellCount(); ++i) {
+            if (!(cells[i] & (BoardEngine::RevealedBit | BoardEngine::FlaggedBit))
+                && !std::binary_search(result.cells.begin(), result.cells.end(), i)) {
+                best = i;
+                bestProbability = result.interiorProbability;
+                break;
+            }
+        }
+    }
+
+    if (best >= 0) {
+        hint.row = best / cols;
+        hint.col = best % cols;
+        hint.safe = bestProbability <= 0.0;
+        hint.mineProbability = bestProbability;
+    }
+    return hint;
+}
+
+void HintService::recordLatency(double milliseconds)
+{
+    if (static_cast<int>(m_latencies.size()) < LatencySamples) {
+        m_latencies.push_back(milliseconds);
+    } else {
+        m_latencies[m_latencyNext] = milliseconds;
+    }
+    m_latencyNext = (m_latencyNext + 1) % LatencySamples;
+}
+
+double HintService::latencyPercentile(double percentile) const
+{
+    if (m_latencies.empty()) {
+        return 0.0;
+    }
+    std::vector<double> sorted = m_latencies;
+    const size_t rank = std::min(sorted.size() - 1,
+                                 static_cast<size_t>(percentile / 100.0 * (sorted.size() - 1) + 0.5));
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
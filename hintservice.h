@@ -0,0 +1,64 @@
+#ifndef HINTSERVICE_H
+#define HINTSERVICE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "boardengine.h"
+#include "probability.h"
+#include "threadpool.h"
+
+// 异步提示服务：在专用工作线程上对棋盘快照求解，不阻塞界面。
+// 有可证明安全的单元格时给出它，否则给出地雷概率最低的单元格。
+// 结果通过排队调用回到界面线程再发出信号；新的请求或玩家的下一步
+// 会取消进行中的计算，过期的结果不会发出
+class HintService : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Hint {
+        int row = -1;
+        int col = -1;
+        bool safe = false;           // 可以证明安全
+        double mineProbability = 1.0;
+    };
+
+    explicit HintService(QObject *parent = nullptr);
+    ~HintService();
+
+    // 复制引擎当前状态和调用方增量维护的前沿（Solver::frontier()）作为快照并开始计算，
+    // 工作线程上不再扫描整个棋盘
+    void request(const BoardEngine &engine, const std::vector<int> &frontier);
+    void cancel();
+    bool isBusy() const { return m_busy; }
+
+    // 从请求到结果送达的延迟百分位（毫秒），样本为最近 LatencySamples 次
+    double latencyPercentile(double percentile) const;
+    int latencySampleCount() const { return static_cast<int>(m_latencies.size()); }
+
+    static const int LatencySamples = 256;
+
+signals:
+    void hintReady(const HintService::Hint &hint);
+
+private:
+    // 只在工作线程上使用；单线程串行执行，分量缓存跨请求保留
+    ProbabilityEngine m_probability;
+    std::shared_ptr<std::atomic<bool>> m_cancelFlag;
+    bool m_busy = false;
+
+    std::vector<double> m_latencies; // 环形缓冲
+    int m_latencyNext = 0;
+
+    // 放在最后：析构时最先停止，等待进行中的任务结束后其他成员才销毁
+    ThreadPool m_worker{1};
+
+    Hint computeHint(const BoardEngine &snapshot, const std::vector<int> &frontier,
+                     const std::atomic<bool> *cancel);
+    void recordLatency(double milliseconds);
+};
+
+#endif // HINTSERVICE_H
@@ -1,10 +1,12 @@
 #include "mainwindow.h"
+#include "trace.h"
 
 #include <QApplication>
 
 int main(int argc, char *argv[])
 {
     QApplication a(argc, argv);
+    Trace::setThreadName("GUI");
     
     MainWindow w;
     w.show();
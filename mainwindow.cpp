@@ -1,6 +1,22 @@
 #include "mainwindow.h"
 #include <QMessageBox>
 #include <QDesktopServices>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QFileDialog>
+#include <QFile>
+#include <QMenu>
+#include <QInputDialog>
+#include <sstream>
+#include "trace.h"
+#include "rng.h"
+
+namespace {
+
+// 无尽模式的地雷密度，介于中级和高级之间
+const double EndlessDensity = 0.16;
+
+} // namespace
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -47,6 +63,7 @@ void MainWindow::setupUI()
     m_difficultyComboBox->addItem("中级");
     m_difficultyComboBox->addItem("高级");
     m_difficultyComboBox->addItem("自定义"); // 添加自定义选项
+    m_difficultyComboBox->addItem("无尽");   // 无边界的棋盘，见 EndlessView
     m_controlLayout->addWidget(m_difficultyComboBox);
 
     // 创建自定义输入字段的布局
@@ -90,6 +107,57 @@ void MainWindow::setupUI()
     m_colsInput->setEnabled(false);
     m_minesInput->setEnabled(false);
     
+    // 创建无猜模式开关，悬停时显示当前难度的生成统计
+    m_noGuessCheckBox = new QCheckBox("无猜模式");
+    m_controlLayout->addWidget(m_noGuessCheckBox);
+    
+    // 创建提示按钮，悬停时显示最近的提示延迟
+    m_hintButton = new QPushButton("提示");
+    m_controlLayout->addWidget(m_hintButton);
+    
+    // 创建撤销和重做按钮，使用系统的标准快捷键
+    m_undoButton = new QPushButton("撤销");
+    m_undoButton->setShortcut(QKeySequence::Undo);
+    m_controlLayout->addWidget(m_undoButton);
+    m_redoButton = new QPushButton("重做");
+    m_redoButton->setShortcut(QKeySequence::Redo);
+    m_controlLayout->addWidget(m_redoButton);
+    
+    // 创建展开动画开关
+    m_animateCheckBox = new QCheckBox("展开动画");
+    m_controlLayout->addWidget(m_animateCheckBox);
+    
+    // 创建性能跟踪开关，关闭时导出 Chrome trace，悬停时显示输入延迟
+    m_traceCheckBox = new QCheckBox("性能跟踪");
+    m_traceCheckBox->setToolTip("记录引擎和绘制的耗时、输入到绘制的延迟以及超过16 ms的卡顿");
+    m_controlLayout->addWidget(m_traceCheckBox);
+    m_stallWatchdog = new StallWatchdog(this);
+    
+    // 创建录像菜单：保存本局或回放录像文件
+    m_replayButton = new QPushButton("录像");
+    QMenu *replayMenu = new QMenu(m_replayButton);
+    replayMenu->addAction("保存本局录像...", this, &MainWindow::saveReplay);
+    replayMenu->addAction("播放录像...", this, &MainWindow::openReplay);
+    m_replayButton->setMenu(replayMenu);
+    m_controlLayout->addWidget(m_replayButton);
+    
+    // 创建存档菜单：保存进行中的对局或读取存档继续
+    m_saveButton = new QPushButton("存档");
+    QMenu *saveMenu = new QMenu(m_saveButton);
+    saveMenu->addAction("保存对局...", this, &MainWindow::saveGame);
+    saveMenu->addAction("读取存档...", this, &MainWindow::loadGame);
+    m_saveButton->setMenu(saveMenu);
+    m_controlLayout->addWidget(m_saveButton);
+    
+    // 创建棋盘库菜单：打开后新对局从预生成的棋盘中选取
+    m_corpusButton = new QPushButton("棋盘库");
+    m_corpusButton->setToolTip("未打开棋盘库");
+    QMenu *corpusMenu = new QMenu(m_corpusButton);
+    corpusMenu->addAction("打开棋盘库...", this, &MainWindow::openCorpus);
+    corpusMenu->addAction("关闭棋盘库", this, &MainWindow::closeCorpus);
+    m_corpusButton->setMenu(corpusMenu);
+    m_controlLayout->addWidget(m_corpusButton);
+    
     // 创建计时器
     m_timerLabel = new QLabel("时间: 0");
     m_controlLayout->addWidget(m_timerLabel);
@@ -98,6 +166,11 @@ void MainWindow::setupUI()
     m_gameBoard = new GameBoard(this);
     m_mainLayout->addWidget(m_gameBoard);
     
+    // 创建无尽模式的视图，选择“无尽”难度时代替游戏板
+    m_endlessView = new EndlessView(this);
+    m_endlessView->hide();
+    m_mainLayout->addWidget(m_endlessView);
+    
     // 添加底部信息布局
     QHBoxLayout* bottomLayout = new QHBoxLayout();
     m_mainLayout->addLayout(bottomLayout);
@@ -119,6 +192,28 @@ void MainWindow::setupUI()
     connect(m_gameBoard, &GameBoard::gameOver, this, &MainWindow::onGameOver);
     connect(m_gameBoard, &GameBoard::updateMineCounter, this, &MainWindow::updateMineCounter);
     connect(m_gameBoard, &GameBoard::updateTimer, this, &MainWindow::updateTimer);
+    connect(m_animateCheckBox, &QCheckBox::toggled, m_gameBoard, &GameBoard::setAnimateCascade);
+    connect(m_noGuessCheckBox, &QCheckBox::toggled, m_gameBoard, &GameBoard::setNoGuess);
+    connect(m_hintButton, &QPushButton::clicked, m_gameBoard, &GameBoard::requestHint);
+    connect(m_undoButton, &QPushButton::clicked, m_gameBoard, &GameBoard::undo);
+    connect(m_redoButton, &QPushButton::clicked, m_gameBoard, &GameBoard::redo);
+    connect(m_traceCheckBox, &QCheckBox::toggled, this, &MainWindow::setTracing);
+    connect(m_endlessView, &EndlessView::progressChanged, this, [this](long long revealed, long long flagged) {
+        m_mineCounterLabel->setText(QString("标记: %1").arg(flagged));
+        m_timerLabel->setText(QString("已揭开: %1").arg(revealed));
+    });
+    connect(m_endlessView, &EndlessView::gameOver, this, [this] {
+        QMessageBox::information(this, "游戏结束",
+                                 QString("游戏结束! 共揭开 %1 格").arg(m_endlessView->board().revealedCount()));
+    });
+    connect(m_gameBoard->hintService(), &HintService::hintReady, this, [this] {
+        const HintService *service = m_gameBoard->hintService();
+        m_hintButton->setToolTip(QString("提示延迟（最近 %1 次）: p50 %2 ms, p90 %3 ms, p99 %4 ms")
+                                     .arg(service->latencySampleCount())
+                                     .arg(service->latencyPercentile(50), 0, 'f', 1)
+                                     .arg(service->latencyPercentile(90), 0, 'f', 1)
+                                     .arg(service->latencyPercentile(99), 0, 'f', 1));
+    });
 }
 
 void MainWindow::initializeDifficulties()
@@ -140,6 +235,14 @@ void MainWindow::initializeDifficulties()
 
 void MainWindow::startNewGame()
 {
+    if (m_difficultyComboBox->currentText() == "无尽") {
+        setEndlessMode(true);
+        m_endlessView->newGame(threadLocalRandom(), EndlessDensity);
+        m_endlessView->setFocus();
+        return;
+    }
+    setEndlessMode(false);
+    
     int rows, cols, mines;
     int index = m_difficultyComboBox->currentIndex();
 
@@ -177,6 +280,7 @@ void MainWindow::startNewGame()
     
     // 初始化游戏板
     m_gameBoard->initializeBoard(rows, cols, mines);
+    updateNoGuessStats();
     
     // 调整窗口大小
     int cellSize = 30; // 默认单元格大小
@@ -184,9 +288,14 @@ void MainWindow::startNewGame()
     int windowWidth = cols * cellSize + 20; // 添加一些边距
     int windowHeight = rows * cellSize + controlPanelHeight + 40; // 添加控制面板高度和边距
     
-    // 确保窗口不会太小
+    // 确保窗口不会太小，也不会超出屏幕，大棋盘在窗口内滚动
     windowWidth = qMax(windowWidth, 300);
     windowHeight = qMax(windowHeight, 350);
+    if (QScreen *screen = QGuiApplication::primaryScreen()) {
+        const QRect available = screen->availableGeometry();
+        windowWidth = qMin(windowWidth, available.width());
+        windowHeight = qMin(windowHeight, available.height());
+    }
     
     resize(windowWidth, windowHeight);
     
@@ -194,8 +303,33 @@ void MainWindow::startNewGame()
     m_gameBoard->setFocus();
 }
 
+void MainWindow::setEndlessMode(bool endless)
+{
+    if (endless == !m_endlessView->isHidden()) {
+        return;
+    }
+    
+    // 无尽模式没有撤销、提示、录像、存档和棋盘库；离开普通对局时重置它，停止计时
+    if (endless) {
+        m_gameBoard->resetGame();
+    }
+    m_gameBoard->setVisible(!endless);
+    m_endlessView->setVisible(endless);
+    const QList<QWidget *> boardControls = {m_noGuessCheckBox, m_hintButton, m_undoButton, m_redoButton,
+                                            m_animateCheckBox, m_replayButton, m_saveButton, m_corpusButton};
+    for (QWidget *control : boardControls) {
+        control->setEnabled(!endless);
+    }
+    if (!endless) {
+        updateMineCounter(m_gameBoard->remainingMines());
+        updateTimer(m_gameBoard->elapsedSeconds());
+    }
+}
+
 void MainWindow::onGameOver(bool won)
 {
+    updateNoGuessStats();
+    
     // 显示游戏结果
     QString message = won ? "恭喜你赢了!" : "游戏结束!";
     QMessageBox::information(this, "游戏结束", message);
@@ -212,3 +346,145 @@ void MainWindow::updateTimer(int seconds)
     // 更新计时器
     m_timerLabel->setText(QString("时间: %1").arg(seconds));
 }
+
+void MainWindow::updateNoGuessStats()
+{
+    const NoGuessGenerator::Stats stats = m_gameBoard->noGuessStats();
+    if (stats.boards == 0) {
+        m_noGuessCheckBox->setToolTip("只生成不需要猜测就能解开的棋盘");
+        return;
+    }
+    m_noGuessCheckBox->setToolTip(QString("当前难度已生成 %1 局：接受率 %2%，平均生成时间 %3 ms")
+                                      .arg(stats.boards)
+                                      .arg(stats.acceptanceRate() * 100, 0, 'f', 1)
+                                      .arg(stats.averageMs(), 0, 'f', 1));
+}
+
+void MainWindow::setTracing(bool enabled)
+{
+    if (enabled) {
+        Trace::clear();
+        Trace::setEnabled(true);
+        m_stallWatchdog->setEnabled(true);
+        return;
+    }
+
+    m_stallWatchdog->setEnabled(false);
+    Trace::setEnabled(false);
+    updateTraceStats();
+
+    const QString fileName = QFileDialog::getSaveFileName(this, "保存跟踪记录", "minesweeper-trace.json",
+                                                          "Chrome Trace (*.json)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    std::ostringstream out;
+    Trace::writeChromeTrace(out);
+    QFile file(fileName);
+    const std::string json = out.str();
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+        || file.write(json.data(), static_cast<qint64>(json.size())) != static_cast<qint64>(json.size())) {
+        QMessageBox::warning(this, "保存失败", QString("无法写入 %1").arg(fileName));
+    }
+}
+
+void MainWindow::updateTraceStats()
+{
+    QStringList lines;
+    for (const Trace::LatencyStats &stats : Trace::latencyStats()) {
+        lines << QString("%1（%2 次）: p50 %3 ms, p90 %4 ms, p99 %5 ms")
+                     .arg(QString::fromStdString(stats.action))
+                     .arg(stats.count)
+                     .arg(stats.p50Ms, 0, 'f', 1)
+                     .arg(stats.p90Ms, 0, 'f', 1)
+                     .arg(stats.p99Ms, 0, 'f', 1);
+    }
+    lines << QString("卡顿: %1 次").arg(Trace::stallCount());
+    m_traceCheckBox->setToolTip("输入到绘制的延迟\n" + lines.join("\n"));
+}
+
+void MainWindow::saveReplay()
+{
+    const QString fileName = QFileDialog::getSaveFileName(this, "保存录像", "minesweeper.msreplay",
+                                                          "扫雷录像 (*.msreplay)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    const std::vector<std::uint8_t> data = m_gameBoard->replay().serialize();
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+        || file.write(reinterpret_cast<const char *>(data.data()), static_cast<qint64>(data.size()))
+               != static_cast<qint64>(data.size())) {
+        QMessageBox::warning(this, "保存失败", QString("无法写入 %1").arg(fileName));
+    }
+}
+
+void MainWindow::openReplay()
+{
+    const QString fileName = QFileDialog::getOpenFileName(this, "播放录像", QString(), "扫雷录像 (*.msreplay)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    QFile file(fileName);
+    Replay replay;
+    const QByteArray data = file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+    if (!replay.deserialize(reinterpret_cast<const std::uint8_t *>(data.constData()),
+                            static_cast<std::size_t>(data.size()))) {
+        QMessageBox::warning(this, "无法播放", QString("%1 不是有效的录像文件").arg(fileName));
+        return;
+    }
+
+    bool ok = false;
+    const double speed = QInputDialog::getDouble(this, "播放录像", "回放倍速 (1-100):", 1.0, 1.0, 100.0, 1, &ok);
+    if (ok) {
+        m_gameBoard->playReplay(replay, speed);
+        m_gameBoard->setFocus();
+    }
+}
+
+void MainWindow::saveGame()
+{
+    if (m_gameBoard->isReplaying()) {
+        QMessageBox::information(this, "无法存档", "录像回放期间不能存档");
+        return;
+    }
+    const QString fileName = QFileDialog::getSaveFileName(this, "保存对局", "minesweeper.mssave",
+                                                          "扫雷存档 (*.mssave)");
+    if (!fileName.isEmpty() && !m_gameBoard->saveGame(fileName)) {
+        QMessageBox::warning(this, "保存失败", QString("无法写入 %1").arg(fileName));
+    }
+}
+
+void MainWindow::loadGame()
+{
+    const QString fileName = QFileDialog::getOpenFileName(this, "读取存档", QString(), "扫雷存档 (*.mssave)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    if (!m_gameBoard->loadGame(fileName)) {
+        QMessageBox::warning(this, "无法读取", QString("%1 不是有效的存档文件").arg(fileName));
+        return;
+    }
+    m_gameBoard->setFocus();
+}
+
+void MainWindow::openCorpus()
+{
+    const QString fileName = QFileDialog::getOpenFileName(this, "打开棋盘库", QString(), "扫雷棋盘库 (*.mscorpus)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    if (!m_gameBoard->openCorpus(fileName)) {
+        QMessageBox::warning(this, "无法打开",
+                             QString("%1 不是有效的棋盘库，或者缺少索引文件 %1.idx").arg(fileName));
+        return;
+    }
+    m_corpusButton->setToolTip(QString("%1\n%2 块棋盘").arg(fileName).arg(m_gameBoard->corpus().boardCount()));
+    startNewGame();
+}
+
+void MainWindow::closeCorpus()
+{
+    m_gameBoard->closeCorpus();
+    m_corpusButton->setToolTip("未打开棋盘库");
+}
@@ -6,7 +6,10 @@
 #include <QLabel>
 #include <QComboBox>
 #include <QLineEdit>
+#include <QCheckBox>
 #include "gameboard.h"
+#include "endlessview.h"
+#include "stallwatchdog.h"
 
 class MainWindow : public QMainWindow
 {
@@ -21,10 +24,18 @@ private slots:
     void onGameOver(bool won);
     void updateMineCounter(int count);
     void updateTimer(int seconds);
+    void setTracing(bool enabled);
+    void saveReplay();
+    void openReplay();
+    void saveGame();
+    void loadGame();
+    void openCorpus();
+    void closeCorpus();
 
 private:
-    // 游戏组件
+    // 游戏组件，无尽模式时换成 m_endlessView
     GameBoard *m_gameBoard;
+    EndlessView *m_endlessView;
     
     // 界面元素
     QWidget *m_centralWidget;
@@ -38,6 +49,18 @@ private:
     QLineEdit *m_colsInput;
     QLineEdit *m_minesInput;
     QPushButton *m_customGameButton;
+    QCheckBox *m_animateCheckBox;
+    QPushButton *m_hintButton;
+    QPushButton *m_undoButton;
+    QPushButton *m_redoButton;
+    QCheckBox *m_noGuessCheckBox;
+    QCheckBox *m_traceCheckBox;
+    QPushButton *m_replayButton;
+    QPushButton *m_saveButton;
+    QPushButton *m_corpusButton;
+    
+    // 性能跟踪开启时监测事件循环卡顿
+    StallWatchdog *m_stallWatchdog;
     
     // 游戏难度设置
     struct Difficulty {
@@ -49,6 +72,9 @@ private:
     QVector<Difficulty> m_difficulties;
     
     void setupUI();
+    void updateNoGuessStats();
+    void updateTraceStats();
     void initializeDifficulties();
+    void setEndlessMode(bool endless);
 };
 #endif // MAINWINDOW_H
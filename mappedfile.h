@@ -0,0 +1,32 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 只读映射整个文件。映射是共享的：多个进程打开同一个文件时使用同一份页缓存，
+// 页面在首次访问时才读入。映射期间文件内容不应被截断
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // 打开失败或文件为空时返回 false
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const std::uint8_t *data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+
+private:
+    const std::uint8_t *m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
+#endif // MAPPEDFILE_H
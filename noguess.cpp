@@ -0,0 +1,103 @@
+#include "noguess.h"
+#include "rng.h"
+#include "solver.h"
+#include "threadpool.h"
+#include "trace.h"
+#include <chrono>
+#include <limits>
+
+std::uint64_t NoGuessGenerator::candidateSeed(std::uint64_t baseSeed, long long index)
+{
+    return mix64(baseSeed + 0x9E3779B97F4A7C15ULL * static_cast<std::uint64_t>(index + 1));
+}
+
+bool NoGuessGenerator::isSolvable(BoardEngine &engine, int firstRow, int firstCol)
+{
+    return verify(engine, firstRow, firstCol, nullptr, 0) == Verdict::Solvable;
+}
+
+NoGuessGenerator::Verdict NoGuessGenerator::verify(BoardEngine &engine, int firstRow, int firstCol,
+                                                   const std::atomic<long long> *best, long long index)
+{
+    Solver solver(engine);
+    engine.clearChanges();
+    engine.revealCell(firstRow, firstCol);
+
+    // 只揭开求解器证明安全的格子、标记证明是地雷的格子，直到胜利或无路可走；
+    // 更靠前的候选已经通过时，这个候选的结果不会被采用，提前放弃
+    while (!engine.isGameOver()) {
+        if (best && best->load(std::memory_order_relaxed) < index) {
+            return Verdict::Cancelled;
+        }
+        solver.update(engine.changes());
+        engine.clearChanges();
+        const Solver::Result &result = solver.solve();
+        if (result.safeCells.empty()) {
+            return Verdict::Unsolvable;
+        }
+        for (int cell : result.mineCells) {
+            if (!engine.isFlagged(cell / engine.cols(), cell % engine.cols())) {
+                engine.toggleFlag(cell / engine.cols(), cell % engine.cols());
+            }
+        }
+        for (int cell : result.safeCells) {
+            engine.revealCell(cell / engine.cols(), cell % engine.cols());
+        }
+    }
+    return engine.isGameWon() ? Verdict::Solvable : Verdict::Unsolvable;
+}
+
+bool NoGuessGenerator::generate(int rows, int cols, int mineCount, int firstRow, int firstCol,
+                                std::uint64_t baseSeed, std::uint64_t *seed)
+{
+    TRACE_SPAN("NoGuessGenerator::generate");
+    const auto started = std::chrono::steady_clock::now();
+    ThreadPool &pool = m_pool ? *m_pool : ThreadPool::global();
+
+    // 每个参与者领取下一个候选序号；best 记录已通过的最小序号，
+    // 大于它的候选不再领取，已在验证的在求解的每一轮检查它并提前返回，
+    // 把线程池让给预生成等其他任务
+    std::atomic<long long> next{0};
+    std::atomic<long long> best{std::numeric_limits<long long>::max()};
+    std::atomic<long long> verified{0};
+
+    const int workers = pool.threadCount() + 1;
+    pool.parallelFor(workers, [&](int) {
+        BoardEngine engine;
+        for (;;) {
+            const long long index = next.fetch_add(1);
+            if (index >= MaxCandidates || index > best.load()) {
+                return;
+            }
+            engine.reset(rows, cols, mineCount);
+            engine.placeMines(firstRow, firstCol, candidateSeed(baseSeed, index));
+            // 被取消的候选没有得出结论，不计入接受率的分母
+            const Verdict verdict = verify(engine, firstRow, firstCol, &best, index);
+            if (verdict != Verdict::Cancelled) {
+                verified.fetch_add(1);
+            }
+            if (verdict == Verdict::Solvable) {
+                long long current = best.load();
+                while (index < current && !best.compare_exchange_weak(current, index)) {
+                }
+                return;
+            }
+        }
+    });
+
+    const bool found = best.load() < MaxCandidates;
+    *seed = candidateSeed(baseSeed, found ? best.load() : 0);
+
+    Stats &stats = m_stats[std::make_tuple(rows, cols, mineCount)];
+    stats.boards++;
+    stats.candidates += verified.load();
+    stats.failures += found ? 0 : 1;
+    stats.totalMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    return found;
+}
+
+NoGuessGenerator::Stats NoGuessGenerator::stats(int rows, int cols, int mineCount) const
+{
+    const auto it = m_stats.find(std::make_tuple(rows, cols, mineCount));
+    return it != m_stats.end() ? it->second : Stats();
+}
@@ -0,0 +1,61 @@
+#ifndef NOGUESS_H
+#define NOGUESS_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include "boardengine.h"
+
+class ThreadPool;
+
+// 无猜棋盘生成器：不断尝试候选种子，用确定性求解器从首次点击开始
+// 模拟对局，只接受不需要猜测就能解开的棋盘。候选在线程池上并行验证，
+// 一旦有候选通过就停止领取、并提前结束更靠后的候选；结果取通过的最小候选序号，
+// 因此相同的基础种子总是得到相同的棋盘
+class NoGuessGenerator
+{
+public:
+    struct Stats {
+        long long boards = 0;     // 生成请求数
+        long long candidates = 0; // 验证完成的候选数，中途被取消的不计
+        long long failures = 0;   // 达到候选上限仍未找到的请求数
+        double totalMs = 0;
+
+        double acceptanceRate() const { return candidates ? double(boards - failures) / candidates : 0; }
+        double averageMs() const { return boards ? totalMs / boards : 0; }
+    };
+
+    // 单次生成最多验证的候选数，之后退回普通棋盘
+    static const int MaxCandidates = 20000;
+
+    // pool 为空时使用 ThreadPool::global()
+    explicit NoGuessGenerator(ThreadPool *pool = nullptr) : m_pool(pool) {}
+
+    // 寻找一个种子，使 placeMines(firstRow, firstCol, seed) 得到无猜棋盘。
+    // 找不到时返回 false，*seed 为第一个候选
+    bool generate(int rows, int cols, int mineCount, int firstRow, int firstCol,
+                  std::uint64_t baseSeed, std::uint64_t *seed);
+
+    // 引擎中已放置地雷且尚未揭开任何单元格：只靠求解器能否从首次点击解开全盘。
+    // 会修改引擎状态
+    static bool isSolvable(BoardEngine &engine, int firstRow, int firstCol);
+
+    // 第 index 个候选的种子
+    static std::uint64_t candidateSeed(std::uint64_t baseSeed, long long index);
+
+    // 按 (行, 列, 雷数) 统计的接受率和平均生成时间
+    Stats stats(int rows, int cols, int mineCount) const;
+
+private:
+    enum class Verdict { Solvable, Unsolvable, Cancelled };
+
+    // isSolvable 的实现；best 不为空且已有比 index 更靠前的候选通过时提前返回 Cancelled
+    static Verdict verify(BoardEngine &engine, int firstRow, int firstCol,
+                          const std::atomic<long long> *best, long long index);
+
+    ThreadPool *m_pool;
+    std::map<std::tuple<int, int, int>, Stats> m_stats;
+};
+
+#endif // NOGUESS_H
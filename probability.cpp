@@ -0,0 +1,429 @@
+#include "probability.h"
+#include "rng.h"
+#include "threadpool.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+
+using Constraint = Solver::Constraint;
+
+int findRoot(std::vector<int> &parent, int x)
+{
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+// 多项式乘法（按地雷数卷积），结果按最大值归一化以免连乘溢出
+std::vector<double> convolve(const std::vector<double> &a, const std::vector<double> &b)
+{
+    std::vector<double> out(a.size() + b.size() - 1, 0.0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i] == 0) {
+            continue;
+        }
+        for (size_t j = 0; j < b.size(); ++j) {
+            out[i + j] += a[i] * b[j];
+        }
+    }
+    const double peak = *std::max_element(out.begin(), out.end());
+    if (peak > 0) {
+        for (double &value : out) {
+            value /= peak;
+        }
+    }
+    return out;
+}
+
+double logChoose(int n, int k)
+{
+    return std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(n - k + 1.0);
+}
+
+// 一个分量的回溯枚举。变量按约束图的广度优先顺序赋值，
+// 使每个约束尽早被完全赋值；每步检查上下界剪枝
+class Enumerator
+{
+public:
+    Enumerator(const std::vector<Constraint> &constraints, const std::vector<int> &cells,
+               const std::atomic<bool> *cancel)
+        : m_cellCount(static_cast<int>(cells.size())), m_cancel(cancel)
+    {
+        const int n = m_cellCount;
+        m_varConstraints.resize(n);
+        m_mines.reserve(constraints.size());
+        m_unassigned.reserve(constraints.size());
+        for (const Constraint &constraint : constraints) {
+            const int id = static_cast<int>(m_mines.size());
+            m_mines.push_back(constraint.mines);
+            m_unassigned.push_back(constraint.unknownCount);
+            m_assignedMines.push_back(0);
+            for (int i = 0; i < constraint.unknownCount; ++i) {
+                const int var = static_cast<int>(std::lower_bound(cells.begin(), cells.end(), constraint.unknowns[i])
+                                                 - cells.begin());
+                m_varConstraints[var].push_back(id);
+            }
+        }
+
+        // 广度优先的赋值顺序
+        std::vector<std::vector<int>> constraintVars(constraints.size());
+        for (int var = 0; var < n; ++var) {
+            for (int id : m_varConstraints[var]) {
+                constraintVars[id].push_back(var);
+            }
+        }
+        std::vector<char> queued(n, 0);
+        for (int seed = 0; seed < n; ++seed) {
+            if (queued[seed]) {
+                continue;
+            }
+            queued[seed] = 1;
+            m_order.push_back(seed);
+            for (size_t head = m_order.size() - 1; head < m_order.size(); ++head) {
+                for (int id : m_varConstraints[m_order[head]]) {
+                    for (int var : constraintVars[id]) {
+                        if (!queued[var]) {
+                            queued[var] = 1;
+                            m_order.push_back(var);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    bool run(std::vector<double> *solutions, std::vector<std::vector<double>> *mineCounts)
+    {
+        m_solutions = solutions;
+        m_mineCounts = mineCounts;
+        solutions->assign(m_cellCount + 1, 0.0);
+        mineCounts->assign(m_cellCount + 1, std::vector<double>());
+        search(0);
+        return !m_stopped;
+    }
+
+    bool cancelled() const { return m_cancel && m_cancel->load(std::memory_order_relaxed); }
+
+private:
+    int m_cellCount;
+    const std::atomic<bool> *m_cancel;
+    bool m_stopped = false; // 超出节点预算或被取消
+    std::vector<std::vector<int>> m_varConstraints;
+    std::vector<int> m_mines;
+    std::vector<int> m_unassigned;
+    std::vector<int> m_assignedMines;
+    std::vector<int> m_order;
+    std::vector<int> m_mineVars; // 当前赋值为地雷的变量
+    std::vector<double> *m_solutions = nullptr;
+    std::vector<std::vector<double>> *m_mineCounts = nullptr;
+    long long m_nodes = 0;
+    std::size_t m_countEntries = 0; // 已分配的 mineCounts 元素数
+
+    bool assign(int var, int value)
+    {
+        bool feasible = true;
+        for (int id : m_varConstraints[var]) {
+            m_unassigned[id]--;
+            m_assignedMines[id] += value;
+            if (m_assignedMines[id] > m_mines[id] || m_assignedMines[id] + m_unassigned[id] < m_mines[id]) {
+                feasible = false;
+            }
+        }
+        return feasible;
+    }
+
+    void unassign(int var, int value)
+    {
+        for (int id : m_varConstraints[var]) {
+            m_unassigned[id]++;
+            m_assignedMines[id] -= value;
+        }
+    }
+
+    void search(int depth)
+    {
+        if (m_stopped) {
+            return;
+        }
+        if (++m_nodes > ProbabilityEngine::MaxSearchNodes || ((m_nodes & 0xFFF) == 0 && cancelled())) {
+            m_stopped = true;
+            return;
+        }
+        if (depth == m_cellCount) {
+            // 每种地雷数的计数行在第一次出现这种解时才分配，超出内存预算同样按超预算处理
+            const int k = static_cast<int>(m_mineVars.size());
+            std::vector<double> &counts = (*m_mineCounts)[k];
+            if (counts.empty()) {
+                if (m_countEntries + m_cellCount > ProbabilityEngine::MaxCountEntries) {
+                    m_stopped = true;
+                    return;
+                }
+                counts.assign(m_cellCount, 0.0);
+                m_countEntries += m_cellCount;
+            }
+            (*m_solutions)[k] += 1;
+            for (int var : m_mineVars) {
+                counts[var] += 1;
+            }
+            return;
+        }
+
+        const int var = m_order[depth];
+        for (int value = 0; value <= 1; ++value) {
+            if (assign(var, value)) {
+                if (value) {
+                    m_mineVars.push_back(var);
+                }
+                search(depth + 1);
+                if (value) {
+                    m_mineVars.pop_back();
+                }
+            }
+            unassign(var, value);
+        }
+    }
+};
+
+} // namespace
+
+void ProbabilityEngine::enumerate(const std::vector<Constraint> &constraints, const std::atomic<bool> *cancel,
+                                  Component *component)
+{
+    Enumerator enumerator(constraints, component->cells, cancel);
+    component->exact = enumerator.run(&component->solutions, &component->mineCounts);
+    component->cancelled = enumerator.cancelled();
+
+    const double peak = *std::max_element(component->solutions.begin(), component->solutions.end());
+    if (peak > 0) {
+        for (double &value : component->solutions) {
+            value /= peak;
+        }
+        for (std::vector<double> &counts : component->mineCounts) {
+            for (double &value : counts) {
+                value /= peak;
+            }
+        }
+    }
+}
+
+const ProbabilityEngine::Result &ProbabilityEngine::compute(const BoardEngine &engine,
+                                                            const std::vector<Constraint> &constraints)
+{
+    TRACE_SPAN("ProbabilityEngine::compute");
+    m_result = Result();
+
+    // 前沿未知格，用并查集按共享约束合并成连通分量
+    std::vector<int> frontier;
+    for (const Constraint &constraint : constraints) {
+        frontier.insert(frontier.end(), constraint.unknowns, constraint.unknowns + constraint.unknownCount);
+    }
+    std::sort(frontier.begin(), frontier.end());
+    frontier.erase(std::unique(frontier.begin(), frontier.end()), frontier.end());
+    auto positionOf = [&](int cell) {
+        return static_cast<int>(std::lower_bound(frontier.begin(), frontier.end(), cell) - frontier.begin());
+    };
+
+    std::vector<int> parent(frontier.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    for (const Constraint &constraint : constraints) {
+        for (int i = 1; i < constraint.unknownCount; ++i) {
+            const int a = findRoot(parent, positionOf(constraint.unknowns[0]));
+            const int b = findRoot(parent, positionOf(constraint.unknowns[i]));
+            parent[std::max(a, b)] = std::min(a, b); // 根总是分量中最小的格，分量顺序确定
+        }
+    }
+
+    // 按根分组约束和格子
+    std::vector<int> componentOf(frontier.size(), -1);
+    std::vector<std::vector<Constraint>> groups;
+    std::vector<std::vector<int>> groupCells;
+    for (size_t i = 0; i < frontier.size(); ++i) {
+        const int root = findRoot(parent, static_cast<int>(i));
+        if (componentOf[root] < 0) {
+            componentOf[root] = static_cast<int>(groups.size());
+            groups.emplace_back();
+            groupCells.emplace_back();
+        }
+        componentOf[i] = componentOf[root];
+        groupCells[componentOf[i]].push_back(frontier[i]);
+    }
+    for (const Constraint &constraint : constraints) {
+        if (constraint.unknownCount > 0) {
+            groups[componentOf[positionOf(constraint.unknowns[0])]].push_back(constraint);
+        }
+    }
+
+    // 查缓存，未命中的分量放到线程池上并行枚举。缓存过大时整体清空，
+    // 本次所有分量重新枚举（unordered_map 插入不会使已有元素的指针失效）
+    if (m_cache.size() > MaxCacheEntries) {
+        m_cache.clear();
+    }
+    const int componentCount = static_cast<int>(groups.size());
+    std::vector<const Component *> components(componentCount, nullptr);
+    std::vector<Component> computed;
+    std::vector<int> computedGroup;
+    std::vector<std::uint64_t> computedHash;
+    for (int g = 0; g < componentCount; ++g) {
+        std::vector<int> key;
+        std::uint64_t hash = 0x9E3779B97F4A7C15ULL;
+        for (const Constraint &constraint : groups[g]) {
+            key.push_back(constraint.mines);
+            key.push_back(constraint.unknownCount);
+            key.insert(key.end(), constraint.unknowns, constraint.unknowns + constraint.unknownCount);
+        }
+        for (int value : key) {
+            hash = mix64(hash ^ static_cast<std::uint32_t>(value));
+        }
+
+        const auto it = m_cache.find(hash);
+        if (it != m_cache.end() && it->second.key == key) {
+            components[g] = &it->second;
+            m_result.cachedComponents++;
+            continue;
+        }
+        Component component;
+        component.key = std::move(key);
+        component.cells = groupCells[g];
+        computed.push_back(std::move(component));
+        computedGroup.push_back(g);
+        computedHash.push_back(hash);
+    }
+
+    ThreadPool &pool = m_pool ? *m_pool : ThreadPool::global();
+    pool.parallelFor(static_cast<int>(computed.size()), [&](int i) {
+        enumerate(groups[computedGroup[i]], m_cancelFlag, &computed[i]);
+    });
+    for (const Component &component : computed) {
+        if (component.cancelled) {
+            // 被取消的分量不完整，不能进入缓存
+            m_result.cancelled = true;
+            m_result.exact = false;
+            return m_result;
+        }
+    }
+
+    // 超出预算的近似结果不缓存，之后预算更充足的调用可以重新枚举
+    for (size_t i = 0; i < computed.size(); ++i) {
+        if (!computed[i].exact) {
+            components[computedGroup[i]] = &computed[i];
+            continue;
+        }
+        Component &entry = m_cache[computedHash[i]];
+        entry = std::move(computed[i]);
+        components[computedGroup[i]] = &entry;
+    }
+
+    // 剩余地雷数和内部格数只来自可见信息：计数器和未揭开的格子数
+    const int remaining = engine.mineCount() - engine.flaggedCount();
+    const int unknown = engine.hiddenSafeCells() + engine.mineCount() - engine.flaggedCount();
+    const int interior = unknown - static_cast<int>(frontier.size());
+
+    // 每个分量的地雷数分布做卷积，前缀/后缀积给出“其他分量”的分布
+    std::vector<std::vector<double>> prefix(componentCount + 1), suffix(componentCount + 1);
+    prefix[0] = {1.0};
+    suffix[componentCount] = {1.0};
+    for (int g = 0; g < componentCount; ++g) {
+        prefix[g + 1] = convolve(prefix[g], components[g]->solutions);
+    }
+    for (int g = componentCount - 1; g >= 0; --g) {
+        suffix[g] = convolve(components[g]->solutions, suffix[g + 1]);
+    }
+
+    // 前沿共有 K 颗地雷时内部的组合数 C(interior, remaining - K)，取对数后归一化
+    const int maxFrontierMines = static_cast<int>(prefix[componentCount].size()) - 1;
+    std::vector<double> weight(maxFrontierMines + 1, 0.0);
+    double maxLog = -HUGE_VAL;
+    for (int k = 0; k <= maxFrontierMines; ++k) {
+        if (remaining - k >= 0 && remaining - k <= interior) {
+            maxLog = std::max(maxLog, logChoose(interior, remaining - k));
+        }
+    }
+    for (int k = 0; k <= maxFrontierMines; ++k) {
+        if (remaining - k >= 0 && remaining - k <= interior) {
+            weight[k] = std::exp(logChoose(interior, remaining - k) - maxLog);
+        }
+    }
+
+    std::vector<std::pair<int, double>> cellProbabilities;
+    cellProbabilities.reserve(frontier.size());
+    bool consistent = true;
+    for (int g = 0; g < componentCount; ++g) {
+        const Component &component = *components[g];
+        const std::vector<double> others = convolve(prefix[g], suffix[g + 1]);
+        const int n = static_cast<int>(component.cells.size());
+
+        // g[k]：本分量有 k 颗地雷时其余部分的总权重
+        std::vector<double> rest(n + 1, 0.0);
+        for (int k = 0; k <= n; ++k) {
+            for (size_t j = 0; j < others.size() && k + j < weight.size(); ++j) {
+                rest[k] += others[j] * weight[k + j];
+            }
+        }
+        double total = 0;
+        for (int k = 0; k <= n; ++k) {
+            total += component.solutions[k] * rest[k];
+        }
+        if (total <= 0) {
+            consistent = false;
+        }
+        std::vector<double> mine(n, 0.0);
+        for (int k = 0; k <= n; ++k) {
+            const std::vector<double> &counts = component.mineCounts[k];
+            for (size_t v = 0; v < counts.size(); ++v) {
+                mine[v] += counts[v] * rest[k];
+            }
+        }
+        for (int v = 0; v < n; ++v) {
+            cellProbabilities.emplace_back(component.cells[v], total > 0 ? mine[v] / total : 0.5);
+        }
+        m_result.exact = m_result.exact && component.exact;
+    }
+
+    // 内部格的期望地雷数 / 内部格数
+    const std::vector<double> &all = prefix[componentCount];
+    double total = 0, interiorMines = 0;
+    for (int k = 0; k <= maxFrontierMines; ++k) {
+        total += all[k] * weight[k];
+        interiorMines += all[k] * weight[k] * (remaining - k);
+    }
+    if (total <= 0) {
+        consistent = false;
+    }
+    m_result.interiorCells = interior;
+    m_result.interiorProbability = (interior > 0 && total > 0) ? interiorMines / total / interior : 0;
+
+    std::sort(cellProbabilities.begin(), cellProbabilities.end());
+    m_result.cells.reserve(cellProbabilities.size());
+    m_result.probabilities.reserve(cellProbabilities.size());
+    for (const auto &entry : cellProbabilities) {
+        m_result.cells.push_back(entry.first);
+        m_result.probabilities.push_back(entry.second);
+    }
+    m_result.components = componentCount;
+    m_result.exact = m_result.exact && consistent;
+    return m_result;
+}
+
+void ProbabilityEngine::fillBoard(const BoardEngine &engine, std::vector<float> *probabilities) const
+{
+    const std::vector<std::uint8_t> &cells = engine.cells();
+    probabilities->resize(cells.size());
+    const float interior = static_cast<float>(m_result.interiorProbability);
+    for (size_t i = 0; i < cells.size(); ++i) {
+        if (cells[i] & BoardEngine::RevealedBit) {
+            (*probabilities)[i] = 0.0f;
+        } else if (cells[i] & BoardEngine::FlaggedBit) {
+            (*probabilities)[i] = 1.0f;
+        } else {
+            (*probabilities)[i] = interior;
+        }
+    }
+    for (size_t i = 0; i < m_result.cells.size(); ++i) {
+        (*probabilities)[m_result.cells[i]] = static_cast<float>(m_result.probabilities[i]);
+    }
+}
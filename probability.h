@@ -0,0 +1,73 @@
+#ifndef PROBABILITY_H
+#define PROBABILITY_H
+
+#include <atomic>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "boardengine.h"
+#include "solver.h"
+
+class ThreadPool;
+
+// 精确的地雷概率计算。前沿的未知格按共享约束分成互不相关的连通分量，
+// 每个分量在线程池上独立回溯枚举（带剪枝），统计含 k 颗地雷的解的个数；
+// 再按剩余地雷总数对内部格（不与任何数字相邻的未知格）的组合数加权合并。
+// 分量结果按约束内容缓存，走一步之后只有被触及的分量需要重新枚举
+class ProbabilityEngine
+{
+public:
+    struct Result {
+        std::vector<int> cells;            // 前沿未知格，升序
+        std::vector<double> probabilities; // 与 cells 一一对应
+        double interiorProbability = 0;    // 每个内部格是地雷的概率
+        int interiorCells = 0;
+        int components = 0;
+        int cachedComponents = 0;          // 直接取自缓存的分量数
+        bool exact = true;                 // 有分量超出枚举预算或局面矛盾时为 false
+        bool cancelled = false;            // 计算途中被取消，结果不可用
+    };
+
+    // pool 为空时使用 ThreadPool::global()
+    explicit ProbabilityEngine(ThreadPool *pool = nullptr) : m_pool(pool) {}
+
+    // 根据求解器给出的约束计算概率（约束中已代入标记）
+    const Result &compute(const BoardEngine &engine, const std::vector<Solver::Constraint> &constraints);
+
+    // 把最近一次结果展开成整个棋盘的概率：已揭开为0，已标记为1
+    void fillBoard(const BoardEngine &engine, std::vector<float> *probabilities) const;
+
+    // 取消标志：置位后正在进行的枚举尽快返回，结果标记为 cancelled
+    void setCancelFlag(const std::atomic<bool> *flag) { m_cancelFlag = flag; }
+
+    void clearCache() { m_cache.clear(); }
+    std::size_t cacheSize() const { return m_cache.size(); }
+
+    // 单个分量最多搜索的节点数，超出后用已找到的解近似
+    static const long long MaxSearchNodes = 20000000;
+    // 单个分量按地雷数分行的计数最多占用的元素数（行在出现对应的解时才分配）
+    static const std::size_t MaxCountEntries = std::size_t(4) << 20;
+    static const std::size_t MaxCacheEntries = 4096;
+
+private:
+    // 一个分量的枚举结果，数值按最大值归一化
+    struct Component {
+        std::vector<int> key;          // 规范化的约束内容，用于校验哈希碰撞
+        std::vector<int> cells;        // 升序
+        std::vector<double> solutions; // solutions[k]：恰有 k 颗地雷的解数
+        // mineCounts[k][v]：其中第 v 格是地雷的解数；没有 k 颗地雷的解时该行为空
+        std::vector<std::vector<double>> mineCounts;
+        bool exact = true;
+        bool cancelled = false;
+    };
+
+    ThreadPool *m_pool;
+    const std::atomic<bool> *m_cancelFlag = nullptr;
+    std::unordered_map<std::uint64_t, Component> m_cache;
+    Result m_result;
+
+    static void enumerate(const std::vector<Solver::Constraint> &constraints, const std::atomic<bool> *cancel,
+                          Component *component);
+};
+
+#endif // PROBABILITY_H
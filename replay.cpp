@@ -0,0 +1,295 @@
+#include "replay.h"
+#include "undolog.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const char Magic[4] = {'M', 'S', 'R', 'P'};
+
+// 一条记录最多占用的字节数：时间差和单元格差各一个64位变长整数
+const std::size_t MaxRecordBytes = 20;
+
+// 动作在记录第二个整数里占的位数
+const int ActionBits = 3;
+
+// 预留的记录数，超过后才扩容
+const std::size_t ReservedRecords = 16384;
+
+inline void putVarint(std::vector<std::uint8_t> &out, std::uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+inline bool getVarint(const std::uint8_t *&data, const std::uint8_t *end, std::uint64_t *value)
+{
+    std::uint64_t result = 0;
+    for (int shift = 0; shift < 64 && data < end; shift += 7) {
+        const std::uint8_t byte = *data++;
+        result |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline std::uint64_t zigzag(std::int64_t value)
+{
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t unzigzag(std::uint64_t value)
+{
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+} // namespace
+
+Replay::Reader::Reader(const Replay &replay)
+    : m_data(replay.m_actions.data()), m_end(replay.m_actions.data() + replay.m_actions.size())
+{
+}
+
+bool Replay::Reader::next(Record *record)
+{
+    std::uint64_t tickDelta = 0;
+    std::uint64_t packed = 0;
+    if (!getVarint(m_data, m_end, &tickDelta) || !getVarint(m_data, m_end, &packed)) {
+        return false;
+    }
+    m_tick += static_cast<std::int64_t>(tickDelta);
+    m_cell += static_cast<int>(unzigzag(packed >> ActionBits));
+    *record = {m_tick, static_cast<Action>(packed & ((1 << ActionBits) - 1)), m_cell};
+    return true;
+}
+
+void Replay::begin(int rows, int cols, int mineCount)
+{
+    m_rows = rows;
+    m_cols = cols;
+    m_mineCount = mineCount;
+    m_layout = NoLayout;
+    m_mines.clear();
+    m_actions.clear();
+    m_actions.reserve(ReservedRecords * 4);
+    m_actionCount = 0;
+    m_lastTick = 0;
+    m_lastCell = 0;
+}
+
+void Replay::setSeed(int firstRow, int firstCol, std::uint64_t seed)
+{
+    m_layout = SeedLayout;
+    m_firstRow = firstRow;
+    m_firstCol = firstCol;
+    m_seed = seed;
+}
+
+void Replay::setMineLayout(const BoardEngine &engine)
+{
+    m_layout = MineLayout;
+    m_mineCount = engine.mineCount();
+    m_mines.clear();
+    m_mines.reserve(engine.mineCount());
+    const std::vector<std::uint8_t> &cells = engine.cells();
+    for (int index = 0; index < engine.cellCount(); ++index) {
+        if (cells[index] & BoardEngine::MineBit) {
+            m_mines.push_back(index);
+        }
+    }
+}
+
+void Replay::append(std::int64_t tick, Action action, int cell)
+{
+    // 预留的空间用完时按倍数扩容，正常对局不会走到这里
+    if (m_actions.capacity() - m_actions.size() < MaxRecordBytes) {
+        m_actions.reserve(m_actions.capacity() * 2 + MaxRecordBytes);
+    }
+    if (action == Undo || action == Redo) {
+        cell = m_lastCell;
+    }
+    tick = std::max(tick, m_lastTick);
+    putVarint(m_actions, static_cast<std::uint64_t>(tick - m_lastTick));
+    putVarint(m_actions, (zigzag(cell - m_lastCell) << ActionBits) | action);
+    m_lastTick = tick;
+    m_lastCell = cell;
+    m_actionCount++;
+}
+
+void Replay::setupBoard(BoardEngine &engine) const
+{
+    engine.reset(m_rows, m_cols, m_mineCount);
+    if (m_layout == SeedLayout) {
+        engine.placeMines(m_firstRow, m_firstCol, m_seed);
+    } else if (m_layout == MineLayout) {
+        engine.setMineLayout(m_mines);
+    }
+}
+
+void Replay::apply(BoardEngine &engine, UndoLog &undo, const Record &record)
+{
+    const int row = record.cell / engine.cols();
+    const int col = record.cell % engine.cols();
+    switch (record.action) {
+    case Reveal:
+        // setupBoard 已经布好雷，与界面一致，撤销只恢复单元格的可见状态
+        undo.begin(engine);
+        engine.revealCell(row, col);
+        undo.commit(engine);
+        break;
+    case Flag:
+        undo.begin(engine);
+        engine.toggleFlag(row, col);
+        undo.commit(engine);
+        break;
+    case Chord:
+        undo.begin(engine);
+        engine.chordCell(row, col);
+        undo.commit(engine);
+        break;
+    case Undo:
+        undo.undo(engine);
+        break;
+    case Redo:
+        undo.redo(engine);
+        break;
+    }
+}
+
+long long Replay::play(BoardEngine &engine) const
+{
+    setupBoard(engine);
+    Reader reader(*this);
+    Record record;
+    long long count = 0;
+    UndoLog undo(SIZE_MAX);
+    while (reader.next(&record)) {
+        // 无界面回放没有观察者，变更集每步清空，避免无限累积
+        apply(engine, undo, record);
+        engine.clearChanges();
+        ++count;
+    }
+    return count;
+}
+
+// 格式：魔数 "MSRP"、版本、行、列、地雷数、布雷方式及其数据、
+// 动作数、动作字节数、动作记录。整数除种子外均为变长编码
+std::vector<std::uint8_t> Replay::serialize() const
+{
+    std::vector<std::uint8_t> out(Magic, Magic + sizeof(Magic));
+    out.reserve(32 + m_mines.size() * 2 + m_actions.size());
+    out.push_back(Version);
+    putVarint(out, m_rows);
+    putVarint(out, m_cols);
+    putVarint(out, m_mineCount);
+    out.push_back(m_layout);
+    if (m_layout == SeedLayout) {
+        for (int i = 0; i < 8; ++i) {
+            out.push_back(static_cast<std::uint8_t>(m_seed >> (8 * i)));
+        }
+        putVarint(out, m_firstRow);
+        putVarint(out, m_firstCol);
+    } else if (m_layout == MineLayout) {
+        // 升序的地雷下标按差值编码
+        putVarint(out, m_mines.size());
+        int previous = 0;
+        for (int index : m_mines) {
+            putVarint(out, index - previous);
+            previous = index;
+        }
+    }
+    putVarint(out, m_actionCount);
+    putVarint(out, m_actions.size());
+    out.insert(out.end(), m_actions.begin(), m_actions.end());
+    return out;
+}
+
+bool Replay::deserialize(const std::uint8_t *data, std::size_t size)
+{
+    const std::uint8_t *end = data + size;
+    if (size < sizeof(Magic) + 1 || std::memcmp(data, Magic, sizeof(Magic)) != 0 || data[4] != Version) {
+        return false;
+    }
+    data += sizeof(Magic) + 1;
+
+    Replay replay;
+    std::uint64_t rows = 0, cols = 0, mines = 0;
+    if (!getVarint(data, end, &rows) || !getVarint(data, end, &cols) || !getVarint(data, end, &mines)
+        || rows == 0 || cols == 0 || rows * cols > (1u << 30) || mines > rows * cols || data >= end) {
+        return false;
+    }
+    replay.m_rows = static_cast<int>(rows);
+    replay.m_cols = static_cast<int>(cols);
+    replay.m_mineCount = static_cast<int>(mines);
+    replay.m_layout = static_cast<Layout>(*data++);
+
+    if (replay.m_layout == SeedLayout) {
+        std::uint64_t firstRow = 0, firstCol = 0;
+        if (end - data < 8) {
+            return false;
+        }
+        for (int i = 0; i < 8; ++i) {
+            replay.m_seed |= static_cast<std::uint64_t>(*data++) << (8 * i);
+        }
+        if (!getVarint(data, end, &firstRow) || !getVarint(data, end, &firstCol)
+            || firstRow >= rows || firstCol >= cols) {
+            return false;
+        }
+        replay.m_firstRow = static_cast<int>(firstRow);
+        replay.m_firstCol = static_cast<int>(firstCol);
+    } else if (replay.m_layout == MineLayout) {
+        std::uint64_t count = 0;
+        if (!getVarint(data, end, &count) || count > rows * cols) {
+            return false;
+        }
+        replay.m_mines.reserve(count);
+        std::uint64_t index = 0;
+        for (std::uint64_t i = 0; i < count; ++i) {
+            std::uint64_t delta = 0;
+            if (!getVarint(data, end, &delta) || (i > 0 && delta == 0)) {
+                return false;
+            }
+            index += delta;
+            if (index >= rows * cols) {
+                return false;
+            }
+            replay.m_mines.push_back(static_cast<int>(index));
+        }
+        replay.m_mineCount = static_cast<int>(count);
+    } else if (replay.m_layout != NoLayout) {
+        return false;
+    }
+
+    std::uint64_t actionCount = 0, actionBytes = 0;
+    if (!getVarint(data, end, &actionCount) || !getVarint(data, end, &actionBytes)
+        || actionBytes != static_cast<std::uint64_t>(end - data)) {
+        return false;
+    }
+    replay.m_actions.assign(data, end);
+    replay.m_actionCount = static_cast<long long>(actionCount);
+
+    // 校验所有记录都能解码且单元格在棋盘内，顺便恢复追加所需的状态
+    Reader reader(replay);
+    Record record;
+    long long decoded = 0;
+    while (reader.next(&record)) {
+        if (record.cell < 0 || record.cell >= replay.m_rows * replay.m_cols || record.action > Redo) {
+            return false;
+        }
+        replay.m_lastTick = record.tick;
+        replay.m_lastCell = record.cell;
+        ++decoded;
+    }
+    if (decoded != replay.m_actionCount) {
+        return false;
+    }
+
+    *this = std::move(replay);
+    return true;
+}
@@ -0,0 +1,98 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "boardengine.h"
+
+class UndoLog;
+
+// 对局录像：棋盘（种子或地雷布局）加上按时间顺序的动作记录。
+// 每条记录是 (时间差, 动作, 单元格差) 的变长整数编码，一般只占2-4字节；
+// 追加记录时写入预留好的缓冲区，正常长度的对局不会分配内存。
+// 回放只通过引擎的公开操作进行，相同的录像总是得到完全相同的局面
+class Replay
+{
+public:
+    enum Action : std::uint8_t {
+        Reveal,
+        Flag,
+        Chord,
+        Undo, // 撤销和重做不关心单元格，记录里沿用上一条的单元格
+        Redo
+    };
+
+    struct Record {
+        std::int64_t tick; // 对局开始后的毫秒数
+        Action action;
+        int cell;
+    };
+
+    // 顺序解码动作记录
+    class Reader
+    {
+    public:
+        explicit Reader(const Replay &replay);
+        bool next(Record *record);
+
+    private:
+        const std::uint8_t *m_data;
+        const std::uint8_t *m_end;
+        std::int64_t m_tick = 0;
+        int m_cell = 0;
+    };
+
+    static const int Version = 1;
+
+    // 开始录制新的一局，清空之前的动作
+    void begin(int rows, int cols, int mineCount);
+
+    // 首次点击时的布雷方式：placeMines(firstRow, firstCol, seed)，或者直接给出布局
+    void setSeed(int firstRow, int firstCol, std::uint64_t seed);
+    void setMineLayout(const BoardEngine &engine);
+
+    void append(std::int64_t tick, Action action, int cell);
+
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+    int mineCount() const { return m_mineCount; }
+    long long actionCount() const { return m_actionCount; }
+    bool isEmpty() const { return m_rows <= 0; }
+
+    // 把引擎重置为第一步之前的棋盘（已布雷）
+    void setupBoard(BoardEngine &engine) const;
+
+    // 在引擎上执行一条记录，撤销历史记在 undo 里
+    static void apply(BoardEngine &engine, UndoLog &undo, const Record &record);
+
+    // 无界面回放全部动作，返回执行的动作数；结束时引擎的变更集为空
+    long long play(BoardEngine &engine) const;
+
+    // 序列化为版本化的二进制格式；解析失败时返回 false，当前内容不变
+    std::vector<std::uint8_t> serialize() const;
+    bool deserialize(const std::uint8_t *data, std::size_t size);
+
+private:
+    enum Layout : std::uint8_t {
+        NoLayout,   // 首次点击之前
+        SeedLayout,
+        MineLayout
+    };
+
+    int m_rows = 0;
+    int m_cols = 0;
+    int m_mineCount = 0;
+    Layout m_layout = NoLayout;
+    std::uint64_t m_seed = 0;
+    int m_firstRow = 0;
+    int m_firstCol = 0;
+    std::vector<int> m_mines; // 升序
+
+    std::vector<std::uint8_t> m_actions;
+    long long m_actionCount = 0;
+    std::int64_t m_lastTick = 0;
+    int m_lastCell = 0;
+};
+
+#endif // REPLAY_H
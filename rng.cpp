@@ -0,0 +1,11 @@
+#include "rng.h"
+#include <random>
+
+std::uint64_t threadLocalRandom()
+{
+    thread_local Xoshiro256 generator([] {
+        std::random_device device;
+        return (static_cast<std::uint64_t>(device()) << 32) ^ device();
+    }());
+    return generator.next();
+}
@@ -0,0 +1,83 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+// 快速的伪随机数生成器，均为纯值类型，无锁、可按线程各自持有
+
+// 无状态的64位混合函数（SplitMix64 的输出变换），适合由坐标直接得到随机数
+inline std::uint64_t mix64(std::uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// SplitMix64：用于把一个64位种子扩展成生成器状态，或派生子种子
+class SplitMix64
+{
+public:
+    explicit SplitMix64(std::uint64_t seed) : m_state(seed) {}
+
+    std::uint64_t next()
+    {
+        return mix64(m_state += 0x9E3779B97F4A7C15ULL);
+    }
+
+private:
+    std::uint64_t m_state;
+};
+
+// xoshiro256**：周期 2^256-1，每次生成只需几次移位和乘法
+class Xoshiro256
+{
+public:
+    explicit Xoshiro256(std::uint64_t seed)
+    {
+        SplitMix64 init(seed);
+        for (std::uint64_t &word : m_state) {
+            word = init.next();
+        }
+    }
+
+    std::uint64_t next()
+    {
+        const std::uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+        const std::uint64_t t = m_state[1] << 17;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotl(m_state[3], 45);
+        return result;
+    }
+
+    // [0, bound) 内的均匀整数（Lemire 乘法区间映射，带拒绝修正，无偏）
+    std::uint32_t bounded(std::uint32_t bound)
+    {
+        std::uint64_t product = (next() >> 32) * bound;
+        std::uint32_t low = static_cast<std::uint32_t>(product);
+        if (low < bound) {
+            const std::uint32_t threshold = static_cast<std::uint32_t>(-bound) % bound;
+            while (low < threshold) {
+                product = (next() >> 32) * bound;
+                low = static_cast<std::uint32_t>(product);
+            }
+        }
+        return static_cast<std::uint32_t>(product >> 32);
+    }
+
+    // [0, 1) 内的均匀浮点数
+    double uniform() { return (next() >> 11) * 0x1.0p-53; }
+
+private:
+    std::uint64_t m_state[4];
+
+    static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+// 线程私有的生成器，首次使用时由系统熵源播种，之后无锁
+std::uint64_t threadLocalRandom();
+
+#endif // RNG_H
@@ -0,0 +1,133 @@
+#include "botpolicy.h"
+#include "probability.h"
+#include "solver.h"
+#include "threadpool.h"
+#include <algorithm>
+
+namespace {
+
+// 随机选一个未揭开、未标记的单元格
+int randomUnknown(const BoardEngine &engine, Xoshiro256 &rng)
+{
+    const std::vector<std::uint8_t> &cells = engine.cells();
+    const int count = engine.cellCount();
+    for (;;) {
+        const int index = static_cast<int>(rng.bounded(static_cast<std::uint32_t>(count)));
+        if (!(cells[index] & (BoardEngine::RevealedBit | BoardEngine::FlaggedBit))) {
+            return index;
+        }
+    }
+}
+
+// 每一步都随机猜，作为基线
+class RandomBot : public BotPolicy
+{
+public:
+    const char *name() const override { return "random"; }
+    void beginGame(const BoardEngine &) override {}
+    Move nextMove(const BoardEngine &engine, Xoshiro256 &rng) override
+    {
+        return {randomUnknown(engine, rng), true};
+    }
+};
+
+// 约束传播求解器，没有确定安全的单元格时随机猜
+class SolverBot : public BotPolicy
+{
+public:
+    const char *name() const override { return "solver"; }
+
+    void beginGame(const BoardEngine &engine) override
+    {
+        m_solver.reset(new Solver(engine));
+        m_pending.clear();
+    }
+
+    Move nextMove(const BoardEngine &engine, Xoshiro256 &rng) override
+    {
+        m_solver->update(engine.changes());
+
+        // 上一次求解得到的安全格依次揭开，全部用完后再求解
+        while (!m_pending.empty()) {
+            const int index = m_pending.back();
+            m_pending.pop_back();
+            if (!(engine.cells()[index] & BoardEngine::RevealedBit)) {
+                return {index, false};
+            }
+        }
+        const Solver::Result &result = m_solver->solve();
+        if (!result.safeCells.empty()) {
+            m_pending.assign(result.safeCells.rbegin(), result.safeCells.rend());
+            const int index = m_pending.back();
+            m_pending.pop_back();
+            return {index, false};
+        }
+        return guess(engine, rng);
+    }
+
+protected:
+    std::unique_ptr<Solver> m_solver;
+    std::vector<int> m_pending;
+
+    virtual Move guess(const BoardEngine &engine, Xoshiro256 &rng)
+    {
+        return {randomUnknown(engine, rng), true};
+    }
+};
+
+// 求解器 + 精确概率：必须猜时选地雷概率最低的单元格
+class ProbabilityBot : public SolverBot
+{
+public:
+    const char *name() const override { return "probability"; }
+
+protected:
+    Move guess(const BoardEngine &engine, Xoshiro256 &rng) override
+    {
+        const ProbabilityEngine::Result &result = m_probability.compute(engine, m_solver->constraints());
+        int best = -1;
+        double bestProbability = 2.0;
+        for (size_t i = 0; i < result.cells.size(); ++i) {
+            if (result.probabilities[i] < bestProbability) {
+                bestProbability = result.probabilities[i];
+                best = result.cells[i];
+            }
+        }
+        if (result.interiorCells > 0 && result.interiorProbability < bestProbability) {
+            // 内部格之间没有区别，随机挑一个不在前沿上的
+            for (;;) {
+                const int index = randomUnknown(engine, rng);
+                if (!std::binary_search(result.cells.begin(), result.cells.end(), index)) {
+                    return {index, true};
+                }
+            }
+        }
+        return best >= 0 ? Move{best, true} : Move{randomUnknown(engine, rng), true};
+    }
+
+private:
+    // 分量通常很小，在模拟器线程内直接枚举，不再分派到共享线程池
+    ThreadPool m_inline{1};
+    ProbabilityEngine m_probability{&m_inline};
+};
+
+} // namespace
+
+std::unique_ptr<BotPolicy> BotPolicy::create(const std::string &name)
+{
+    if (name == "random") {
+        return std::unique_ptr<BotPolicy>(new RandomBot());
+    }
+    if (name == "solver") {
+        return std::unique_ptr<BotPolicy>(new SolverBot());
+    }
+    if (name == "probability") {
+        return std::unique_ptr<BotPolicy>(new ProbabilityBot());
+    }
+    return nullptr;
+}
+
+std::vector<std::string> BotPolicy::names()
+{
+    return {"random", "solver", "probability"};
+}
@@ -0,0 +1,34 @@
+#ifndef BOTPOLICY_H
+#define BOTPOLICY_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "boardengine.h"
+#include "rng.h"
+
+// 模拟器中的机器人策略。每个工作线程持有自己的实例，可以保存对局内的状态
+class BotPolicy
+{
+public:
+    struct Move {
+        int index;  // 要揭开的单元格下标
+        bool guess; // 没有可证明安全的单元格，只能猜
+    };
+
+    virtual ~BotPolicy() = default;
+
+    virtual const char *name() const = 0;
+
+    // 新的一局，地雷已放置、尚未揭开任何单元格
+    virtual void beginGame(const BoardEngine &engine) = 0;
+
+    // 选择下一步；自上一步以来的变化在 engine.changes() 中，调用后由模拟器清空
+    virtual Move nextMove(const BoardEngine &engine, Xoshiro256 &rng) = 0;
+
+    // 按名称创建策略，未知名称返回空指针
+    static std::unique_ptr<BotPolicy> create(const std::string &name);
+    static std::vector<std::string> names();
+};
+
+#endif // BOTPOLICY_H
@@ -0,0 +1,409 @@
+#include "selfcheck.h"
+#include "adjacency.h"
+#include "boardcorpus.h"
+#include "boardengine.h"
+#include "boardprefetcher.h"
+#include "chunkedboard.h"
+#include "rng.h"
+#include "solver.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool hasConstraint(const Solver &solver, int cell)
+{
+    const std::vector<Solver::Constraint> &constraints = solver.constraints();
+    return std::any_of(constraints.begin(), constraints.end(),
+                       [cell](const Solver::Constraint &constraint) { return constraint.cell == cell; });
+}
+
+// 本机可用的每种相邻计数内核都与逐格数邻居的参考实现对照：
+// 随机密度的棋盘，列数覆盖不是64（也不是向量宽度）倍数的情况，
+// 高4位的状态必须保持不变
+bool checkAdjacencyKernels()
+{
+    const int sizes[][2] = {{1, 1}, {3, 17}, {7, 63}, {5, 64}, {9, 65}, {4, 100}, {33, 127}, {16, 200}};
+    const Adjacency::Kernel kernels[] = {Adjacency::Kernel::Scalar, Adjacency::Kernel::Sse2,
+                                         Adjacency::Kernel::Avx2};
+    SplitMix64 random(12345);
+    for (const auto &size : sizes) {
+        const int rows = size[0];
+        const int cols = size[1];
+        const int wordsPerRow = Adjacency::wordsPerRow(cols);
+        for (int density : {0, 20, 50, 100}) {
+            std::vector<std::uint64_t> planes(static_cast<std::size_t>(rows) * wordsPerRow, 0);
+            std::vector<std::uint8_t> expected(static_cast<std::size_t>(rows) * cols);
+            auto mine = [&](int r, int c) {
+                return r >= 0 && r < rows && c >= 0 && c < cols
+                    && (planes[r * wordsPerRow + c / 64] >> (c % 64) & 1);
+            };
+            for (int r = 0; r < rows; ++r) {
+                for (int c = 0; c < cols; ++c) {
+                    if (static_cast<int>(random.next() % 100) < density) {
+                        planes[r * wordsPerRow + c / 64] |= std::uint64_t(1) << (c % 64);
+                    }
+                }
+            }
+            for (int r = 0; r < rows; ++r) {
+                for (int c = 0; c < cols; ++c) {
+                    int count = 0;
+                    for (int dr = -1; dr <= 1; ++dr) {
+                        for (int dc = -1; dc <= 1; ++dc) {
+                            count += (dr || dc) && mine(r + dr, c + dc) ? 1 : 0;
+                        }
+                    }
+                    const std::uint8_t high = static_cast<std::uint8_t>((r * cols + c) % 16) << 4;
+                    expected[r * cols + c] = static_cast<std::uint8_t>(high | (mine(r, c) ? 0 : count));
+                }
+            }
+
+            for (Adjacency::Kernel kernel : kernels) {
+                if (!Adjacency::kernelAvailable(kernel)) {
+                    continue;
+                }
+                std::vector<std::uint8_t> cells(expected.size());
+                for (std::size_t i = 0; i < cells.size(); ++i) {
+                    cells[i] = static_cast<std::uint8_t>((expected[i] & 0xF0) | 0x0F);
+                }
+                Adjacency::computeCounts(planes.data(), wordsPerRow, rows, cols, cells.data(), kernel);
+                if (cells != expected) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// 2000x2000 棋盘只有右下角一颗地雷：一次揭示迭代展开整个棋盘（不会爆栈），
+// 每个安全格恰好出现一次，获胜时自动标记的地雷排在最后；
+// changedCells 的容量在 reset 时预留好，展开过程中不再分配
+bool checkLargeCascadeSingleMine()
+{
+    const int rows = 2000;
+    const int cols = 2000;
+    BoardEngine engine;
+    engine.reset(rows, cols, 0);
+    engine.setMineLayout({rows * cols - 1});
+    const std::size_t capacity = engine.changedCells().capacity();
+    const std::vector<int> &changed = engine.revealCell(0, 0);
+    if (!engine.isGameWon() || changed.capacity() != capacity
+        || changed.size() != static_cast<std::size_t>(rows) * cols) {
+        return false;
+    }
+
+    std::vector<bool> seen(changed.size(), false);
+    for (std::size_t i = 0; i < changed.size(); ++i) {
+        const int index = changed[i];
+        if (index < 0 || index >= rows * cols || seen[index]) {
+            return false;
+        }
+        seen[index] = true;
+        // 前 rows*cols-1 项是揭开的安全格，最后一项是被标记的地雷
+        const bool mine = index == rows * cols - 1;
+        if (mine != (i + 1 == changed.size())) {
+            return false;
+        }
+    }
+    return engine.isFlagged(rows - 1, cols - 1);
+}
+
+// 1x6 棋盘，地雷在 0 和 3：揭开 1、2 后，1 唯一的未知邻格是 0。
+// 标记 0 后 1 离开前沿；取消标记后 1 必须重新回到前沿，否则求解器和概率引擎
+// 会把 0 当成内部格
+bool checkUnflagRestoresFrontier()
+{
+    BoardEngine engine;
+    engine.reset(1, 6, 2);
+    engine.setMineLayout({0, 3});
+    engine.revealCell(0, 1);
+    engine.revealCell(0, 2);
+    Solver solver(engine);
+    solver.update(engine.changes());
+    engine.clearChanges();
+
+    auto step = [&](int col) {
+        engine.toggleFlag(0, col);
+        solver.update(engine.changes());
+        engine.clearChanges();
+        solver.solve();
+    };
+    step(0);
+    if (hasConstraint(solver, 1)) {
+        return false;
+    }
+    step(0);
+    return hasConstraint(solver, 1);
+}
+
+// 解开原点所在的块（地雷全部标记）后压缩：块离开内存，cellAt 的结果不变；
+// 再次访问时按种子和标记位图原样恢复
+bool checkChunkCompactRoundTrip()
+{
+    const int size = ChunkedBoard::ChunkSize;
+    ChunkedBoard board;
+    board.reset(7, 0.15);
+    board.revealCell(size / 2, size / 2);
+    for (int r = 0; r < size; ++r) {
+        for (int c = 0; c < size; ++c) {
+            if (!board.isMine(r, c)) {
+                board.revealCell(r, c);
+            } else if (!(board.cellAt(r, c) & BoardEngine::FlaggedBit)) {
+                board.toggleFlag(r, c);
+            }
+        }
+    }
+    if (board.isGameOver()) {
+        return false;
+    }
+
+    std::vector<std::uint8_t> before;
+    for (int r = 0; r < size; ++r) {
+        for (int c = 0; c < size; ++c) {
+            before.push_back(board.cellAt(r, c));
+        }
+    }
+    const std::size_t resident = board.residentChunks();
+    board.compact(100 * size, 100 * size, 1);
+    if (board.compressedChunks() != 1 || board.residentChunks() >= resident) {
+        return false;
+    }
+    auto unchanged = [&] {
+        for (int r = 0; r < size; ++r) {
+            for (int c = 0; c < size; ++c) {
+                if (board.cellAt(r, c) != before[r * size + c]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    if (!unchanged()) {
+        return false;
+    }
+
+    // 已揭开的格子不变，但会触发恢复
+    board.revealCell(size / 2, size / 2);
+    return board.compressedChunks() == 0 && unchanged();
+}
+
+// 没有地雷时一次揭开止于 MaxCascade：每个已揭开的格子要么邻格全部揭开，
+// 要么还在待展开队列里；继续展开会揭开新的格子
+bool checkCappedCascadeQueued()
+{
+    ChunkedBoard board;
+    board.reset(1, 0.0);
+    const std::vector<ChunkedBoard::CellPos> first = board.revealCell(0, 0);
+    if (first.size() < static_cast<std::size_t>(ChunkedBoard::MaxCascade) || !board.cascadePending()) {
+        return false;
+    }
+
+    std::vector<std::uint64_t> pending;
+    for (const ChunkedBoard::CellPos &pos : board.pendingCascade()) {
+        pending.push_back(static_cast<std::uint64_t>(static_cast<std::uint32_t>(pos.row)) << 32
+                          | static_cast<std::uint32_t>(pos.col));
+    }
+    std::sort(pending.begin(), pending.end());
+    for (const ChunkedBoard::CellPos &pos : first) {
+        const std::uint64_t key = static_cast<std::uint64_t>(static_cast<std::uint32_t>(pos.row)) << 32
+                                  | static_cast<std::uint32_t>(pos.col);
+        if (std::binary_search(pending.begin(), pending.end(), key)) {
+            continue;
+        }
+        for (int r = pos.row - 1; r <= pos.row + 1; ++r) {
+            for (int c = pos.col - 1; c <= pos.col + 1; ++c) {
+                if (!(board.cellAt(r, c) & BoardEngine::RevealedBit)) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    const long long revealed = board.revealedCount();
+    board.continueCascade();
+    return board.revealedCount() > revealed;
+}
+
+bool sameConstraints(const std::vector<Solver::Constraint> &a, const std::vector<Solver::Constraint> &b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                      [](const Solver::Constraint &x, const Solver::Constraint &y) {
+                          return x.cell == y.cell && x.mines == y.mines && x.unknownCount == y.unknownCount
+                              && std::equal(x.unknowns, x.unknowns + x.unknownCount, y.unknowns);
+                      });
+}
+
+// 界面把增量维护的前沿交给提示快照：快照上 setFrontier 之后的求解结果
+// 必须与整盘 rebuild 完全相同。随机对局里交替揭开、标记和取消标记
+bool checkHandedFrontierMatchesRebuild()
+{
+    SplitMix64 random(2024);
+    for (int game = 0; game < 20; ++game) {
+        BoardEngine engine;
+        engine.reset(24, 30, 130);
+        engine.placeMines(12, 15, random.next());
+        engine.revealCell(12, 15);
+        Solver incremental(engine);
+        incremental.update(engine.changes());
+        engine.clearChanges();
+
+        for (int step = 0; step < 200 && !engine.isGameOver(); ++step) {
+            const BoardEngine snapshot = engine;
+            Solver handed(snapshot);
+            handed.setFrontier(incremental.frontier());
+            Solver full(snapshot);
+            full.rebuild();
+            const Solver::Result &a = handed.solve();
+            const Solver::Result &b = full.solve();
+            if (a.safeCells != b.safeCells || a.mineCells != b.mineCells
+                || !sameConstraints(handed.constraints(), full.constraints())) {
+                return false;
+            }
+
+            // 有安全格就揭开，否则随机切换一个未揭开格的标记，或者随机揭开
+            const int cell = static_cast<int>(random.next() % engine.cellCount());
+            const int row = cell / engine.cols();
+            const int col = cell % engine.cols();
+            if (!b.safeCells.empty() && random.next() % 4) {
+                const int safe = b.safeCells[random.next() % b.safeCells.size()];
+                engine.revealCell(safe / engine.cols(), safe % engine.cols());
+            } else if (!b.mineCells.empty() && random.next() % 2) {
+                // 前沿上的地雷：标记，之后再次选中时取消，数字格随之离开又回到前沿
+                const int mine = b.mineCells[random.next() % b.mineCells.size()];
+                engine.toggleFlag(mine / engine.cols(), mine % engine.cols());
+            } else if (!engine.isRevealed(row, col) && random.next() % 2) {
+                engine.toggleFlag(row, col);
+            } else if (!engine.isFlagged(row, col) && !engine.isMine(row, col)) {
+                engine.revealCell(row, col);
+            }
+            incremental.update(engine.changes());
+            engine.clearChanges();
+        }
+    }
+    return true;
+}
+
+// 从预生成池取出的普通棋盘与直接生成的分布相同：点击角落时，棋盘中央是否有雷的频率
+// 等于 雷数 / 安全区外的格子数（池中的棋盘若带着中央的安全区，这个频率接近 0）。
+// 雷数接近格子数时，取出的雷数按实际点击钳制
+bool checkPrefetchedBoardsUnbiased()
+{
+    const int rows = 9;
+    const int cols = 9;
+    const int mines = 10;
+    const int samples = 4000;
+    BoardPrefetcher prefetcher;
+    auto takeOne = [&](const BoardPrefetcher::Key &key, int row, int col, BoardEngine *engine) {
+        prefetcher.prefetch(key);
+        while (!prefetcher.take(key, row, col, engine)) {
+            std::this_thread::yield();
+        }
+    };
+
+    const BoardPrefetcher::Key key{rows, cols, mines, BoardPrefetcher::Standard};
+    int centreMines = 0;
+    for (int i = 0; i < samples; ++i) {
+        BoardEngine engine;
+        takeOne(key, 0, 0, &engine);
+        if (engine.mineCount() != mines || engine.isMine(0, 0) || engine.isMine(1, 1)) {
+            return false;
+        }
+        centreMines += engine.isMine(rows / 2, cols / 2) ? 1 : 0;
+    }
+    // 期望 10/77 ≈ 0.13，标准差约 0.005，允许 5 个标准差
+    const double expected = double(mines) / (rows * cols - 4);
+    const double sigma = std::sqrt(expected * (1 - expected) / samples);
+    if (std::abs(double(centreMines) / samples - expected) > 5 * sigma) {
+        return false;
+    }
+
+    // 80 个雷：点击角落时安全区 4 格，最多 77 个；点击中央时 9 格，最多 72 个
+    const BoardPrefetcher::Key dense{rows, cols, 80, BoardPrefetcher::Standard};
+    BoardEngine corner;
+    BoardEngine centre;
+    takeOne(dense, 0, 0, &corner);
+    takeOne(dense, rows / 2, cols / 2, &centre);
+    return corner.mineCount() == rows * cols - 4 && centre.mineCount() == rows * cols - 9
+           && !centre.isMine(rows / 2, cols / 2);
+}
+
+// 棋盘库的记录头和位图不一致时 pick 拒绝这条记录：位图里多出一个地雷后，
+// 同一块棋盘不再被选中
+bool checkCorpusRejectsMismatchedBitmap()
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "minesweeper_selfcheck.mscorpus").string();
+    std::remove(path.c_str());
+    std::remove(BoardCorpus::indexPath(path).c_str());
+
+    BoardEngine engine;
+    engine.reset(9, 9, 10);
+    engine.placeMines(4, 4, 7);
+    BoardCorpusWriter writer;
+    if (!writer.open(path, 81) || !writer.append(engine, 4, 4, 0, 7) || !writer.close()
+        || !BoardCorpus::buildIndex(path)) {
+        return false;
+    }
+
+    BoardCorpus::Query query;
+    query.rows = 9;
+    query.cols = 9;
+    query.mines = 10;
+    BoardCorpus::Board board;
+    BoardCorpus corpus;
+    bool ok = corpus.open(path) && corpus.pick(query, 0, &board);
+    corpus.close();
+
+    // 在开局区外找一个空格，把它在位图里置位：文件头 16 字节，记录头 32 字节
+    int extra = 0;
+    while (engine.isMine(extra / 9, extra % 9) || (std::abs(extra / 9 - 4) <= 1 && std::abs(extra % 9 - 4) <= 1)) {
+        ++extra;
+    }
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        std::uint64_t word = 0;
+        file.seekg(16 + 32);
+        file.read(reinterpret_cast<char *>(&word), sizeof(word));
+        word |= std::uint64_t(1) << extra;
+        file.seekp(16 + 32);
+        file.write(reinterpret_cast<const char *>(&word), sizeof(word));
+        ok = ok && static_cast<bool>(file);
+    }
+    ok = ok && corpus.open(path) && !corpus.pick(query, 0, &board);
+    corpus.close();
+
+    std::remove(path.c_str());
+    std::remove(BoardCorpus::indexPath(path).c_str());
+    return ok;
+}
+
+} // namespace
+
+bool runSelfChecks(std::ostream &log)
+{
+    const std::vector<std::pair<std::string, std::function<bool()>>> checks = {
+        {"adjacency_kernels_match_reference", checkAdjacencyKernels},
+        {"engine_large_cascade_single_mine", checkLargeCascadeSingleMine},
+        {"solver_unflag_restores_frontier", checkUnflagRestoresFrontier},
+        {"solver_handed_frontier_matches_rebuild", checkHandedFrontierMatchesRebuild},
+        {"chunked_compact_round_trip", checkChunkCompactRoundTrip},
+        {"chunked_capped_cascade_queued", checkCappedCascadeQueued},
+        {"prefetched_boards_unbiased", checkPrefetchedBoardsUnbiased},
+        {"corpus_rejects_mismatched_bitmap", checkCorpusRejectsMismatchedBitmap},
+    };
+
+    bool passed = true;
+    for (const auto &check : checks) {
+        const bool ok = check.second();
+        log << (ok ? "PASS " : "FAIL ") << check.first << "\n";
+        passed = passed && ok;
+    }
+    return passed;
+}
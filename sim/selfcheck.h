@@ -0,0 +1,11 @@
+#ifndef SELFCHECK_H
+#define SELFCHECK_H
+
+#include <ostream>
+
+// 无界面的回归检查（minesweeper_sim --check，也注册为 ctest 用例）。
+// 每项检查构造一个小局面，验证引擎和求解器在容易出错的路径上的行为；
+// 每项的结果写到 log，全部通过时返回 true
+bool runSelfChecks(std::ostream &log);
+
+#endif // SELFCHECK_H
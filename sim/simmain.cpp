@@ -0,0 +1,116 @@
+#include "botpolicy.h"
+#include "selfcheck.h"
+#include "simulator.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace {
+
+void printUsage(const char *program)
+{
+    std::cerr << "用法: " << program << " [选项]\n"
+              << "  --games N          每种难度的对局数（默认 10000）\n"
+              << "  --threads T        工作线程数（默认硬件线程数）\n"
+              << "  --seed S           主种子（默认 1）\n"
+              << "  --bot NAME         机器人策略:";
+    for (const std::string &name : BotPolicy::names()) {
+        std::cerr << " " << name;
+    }
+    std::cerr << "（默认 solver）\n"
+              << "  --difficulty LIST  逗号分隔: beginner,intermediate,expert 或 RxC/M（默认三种预设）\n"
+              << "  --no-guess         用无猜生成器出题\n"
+              << "  --corpus FILE      把出的题追加到棋盘库 FILE 并重建索引（无猜模式只收录验证通过的）\n"
+              << "  --format csv|json  输出格式（默认 csv）\n"
+              << "  --check            只运行无界面回归检查，全部通过时退出码为 0\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    Simulator::Options options;
+    std::string difficulties = "beginner,intermediate,expert";
+    bool json = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        const bool hasValue = value != nullptr;
+        if (std::strcmp(arg, "--games") == 0 && hasValue) {
+            options.games = std::atoll(value);
+            ++i;
+        } else if (std::strcmp(arg, "--threads") == 0 && hasValue) {
+            options.threads = std::atoi(value);
+            ++i;
+        } else if (std::strcmp(arg, "--seed") == 0 && hasValue) {
+            options.seed = std::strtoull(value, nullptr, 0);
+            ++i;
+        } else if (std::strcmp(arg, "--bot") == 0 && hasValue) {
+            options.bot = value;
+            ++i;
+        } else if (std::strcmp(arg, "--difficulty") == 0 && hasValue) {
+            difficulties = value;
+            ++i;
+        } else if (std::strcmp(arg, "--corpus") == 0 && hasValue) {
+            options.corpus = value;
+            ++i;
+        } else if (std::strcmp(arg, "--format") == 0 && hasValue) {
+            json = std::strcmp(value, "json") == 0;
+            if (!json && std::strcmp(value, "csv") != 0) {
+                printUsage(argv[0]);
+                return 2;
+            }
+            ++i;
+        } else if (std::strcmp(arg, "--check") == 0) {
+            return runSelfChecks(std::cout) ? 0 : 1;
+        } else if (std::strcmp(arg, "--no-guess") == 0) {
+            options.noGuess = true;
+        } else {
+            printUsage(argv[0]);
+            return std::strcmp(arg, "--help") == 0 ? 0 : 2;
+        }
+    }
+
+    std::stringstream list(difficulties);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        Simulator::Difficulty difficulty;
+        if (!Simulator::parseDifficulty(item, &difficulty)) {
+            std::cerr << "无效的难度: " << item << "\n";
+            return 2;
+        }
+        options.difficulties.push_back(difficulty);
+    }
+    if (options.difficulties.empty() || options.games <= 0 || !BotPolicy::create(options.bot)) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    Simulator simulator(options);
+    const std::vector<Simulator::Stats> stats = simulator.run();
+    if (stats.empty()) {
+        std::cerr << "无法写入棋盘库: " << options.corpus << "\n";
+        return 1;
+    }
+    if (json) {
+        simulator.writeJson(std::cout, stats);
+    } else {
+        simulator.writeCsv(std::cout, stats);
+    }
+
+    // 总耗时和吞吐量写到 stderr，stdout 只有可比较的统计
+    long long games = 0;
+    for (const Simulator::Stats &s : stats) {
+        games += s.games;
+    }
+    std::cerr << games << " games, " << simulator.threadCount() << " threads, "
+              << simulator.elapsedSeconds() << " s, "
+              << (simulator.elapsedSeconds() > 0 ? games / simulator.elapsedSeconds() : 0) << " games/s\n";
+    if (!options.corpus.empty()) {
+        std::cerr << simulator.corpusBoards() << " boards appended to " << options.corpus << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,456 @@
+#include "simulator.h"
+#include "boardcorpus.h"
+#include "boardengine.h"
+#include "botpolicy.h"
+#include "noguess.h"
+#include "rng.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// 每个任务是同一难度下连续的一段对局；粒度足够小，线程之间可以均衡
+const long long ChunkGames = 64;
+
+struct Task {
+    int difficulty;
+    long long first;
+    long long count;
+};
+
+// 工作窃取队列：线程从自己队列的尾部取任务，空了以后从其他队列的头部窃取。
+// 竞争只发生在队列快空的时候，每个任务加一次锁的开销可以忽略
+class TaskQueues
+{
+public:
+    explicit TaskQueues(int workers) : m_queues(workers) {}
+
+    void push(int worker, const Task &task) { m_queues[worker].tasks.push_back(task); }
+
+    bool pop(int worker, Task *task)
+    {
+        {
+            Queue &own = m_queues[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                *task = own.tasks.back();
+                own.tasks.pop_back();
+                return true;
+            }
+        }
+        const int workers = static_cast<int>(m_queues.size());
+        for (int i = 1; i < workers; ++i) {
+            Queue &victim = m_queues[(worker + i) % workers];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                *task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+    std::vector<Queue> m_queues;
+};
+
+// 3BV：揭开全部安全格所需的最少点击数 = 空白连通区的个数
+// + 不与任何空白格相邻的数字格个数
+int computeBbbv(const BoardEngine &engine, std::vector<std::uint8_t> &marks, std::vector<int> &stack)
+{
+    const int rows = engine.rows();
+    const int cols = engine.cols();
+    const std::vector<std::uint8_t> &cells = engine.cells();
+    marks.assign(cells.size(), 0);
+
+    int bbbv = 0;
+    for (int start = 0; start < engine.cellCount(); ++start) {
+        if (marks[start] || (cells[start] & (BoardEngine::MineBit | BoardEngine::CountMask))) {
+            continue;
+        }
+        // 一个空白区域连同它的数字边界只需一次点击
+        ++bbbv;
+        marks[start] = 1;
+        stack.assign(1, start);
+        while (!stack.empty()) {
+            const int index = stack.back();
+            stack.pop_back();
+            if (cells[index] & BoardEngine::CountMask) {
+                continue;
+            }
+            const int r = index / cols;
+            const int c = index % cols;
+            for (int nr = std::max(0, r - 1); nr <= std::min(rows - 1, r + 1); ++nr) {
+                for (int nc = std::max(0, c - 1); nc <= std::min(cols - 1, c + 1); ++nc) {
+                    const int neighbor = nr * cols + nc;
+                    if (!marks[neighbor]) {
+                        marks[neighbor] = 1;
+                        stack.push_back(neighbor);
+                    }
+                }
+            }
+        }
+    }
+    for (int index = 0; index < engine.cellCount(); ++index) {
+        if (!marks[index] && !(cells[index] & BoardEngine::MineBit)) {
+            ++bbbv;
+        }
+    }
+    return bbbv;
+}
+
+// 单个工作线程的状态：引擎和策略跨局复用
+struct Worker {
+    std::unique_ptr<BotPolicy> bot;
+    BoardEngine engine;
+    BoardEngine trial;
+    std::vector<std::uint8_t> marks;
+    std::vector<int> stack;
+    std::vector<Simulator::Stats> stats;
+};
+
+// 各线程共用的棋盘库写入端；出一块题远比加一次锁慢，逐块加锁即可
+struct CorpusSink {
+    BoardCorpusWriter writer;
+    std::mutex mutex;
+};
+
+double elapsedNs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - since).count();
+}
+
+void playGame(const Simulator::Options &options, int difficultyIndex, long long gameIndex, Worker &worker,
+              CorpusSink *corpus)
+{
+    const Simulator::Difficulty &difficulty = options.difficulties[difficultyIndex];
+    Simulator::Stats &stats = worker.stats[difficultyIndex];
+    BoardEngine &engine = worker.engine;
+
+    // 对局序号在所有难度中统一编号，不同难度使用不同的随机流
+    const std::uint64_t seed = Simulator::gameSeed(options.seed, gameIndex + difficultyIndex * options.games);
+    const int firstRow = difficulty.rows / 2;
+    const int firstCol = difficulty.cols / 2;
+
+    // 无猜模式按 NoGuessGenerator 的规则依次验证候选，取第一个通过的。
+    // 模拟器本身已经占满所有核心，这里在当前线程内串行验证
+    const auto generateStarted = std::chrono::steady_clock::now();
+    std::uint64_t boardSeed = seed;
+    bool verified = true;
+    if (options.noGuess) {
+        int candidate = 0;
+        for (; candidate < NoGuessGenerator::MaxCandidates; ++candidate) {
+            boardSeed = NoGuessGenerator::candidateSeed(seed, candidate);
+            worker.trial.reset(difficulty.rows, difficulty.cols, difficulty.mines);
+            worker.trial.placeMines(firstRow, firstCol, boardSeed);
+            if (NoGuessGenerator::isSolvable(worker.trial, firstRow, firstCol)) {
+                break;
+            }
+        }
+        if (candidate == NoGuessGenerator::MaxCandidates) {
+            boardSeed = NoGuessGenerator::candidateSeed(seed, 0);
+            stats.noGuessFailures++;
+            verified = false;
+        }
+    }
+    engine.reset(difficulty.rows, difficulty.cols, difficulty.mines);
+    engine.placeMines(firstRow, firstCol, boardSeed);
+    stats.generateTime.add(Simulator::timeBucket(elapsedNs(generateStarted)));
+    const int bbbv = computeBbbv(engine, worker.marks, worker.stack);
+    stats.bbbv.add(bbbv);
+    if (corpus && verified) {
+        std::lock_guard<std::mutex> lock(corpus->mutex);
+        corpus->writer.append(engine, firstRow, firstCol, bbbv, boardSeed);
+    }
+
+    // 首次点击总是安全的，不算猜测
+    const auto playStarted = std::chrono::steady_clock::now();
+    Xoshiro256 rng(mix64(seed));
+    worker.bot->beginGame(engine);
+    engine.revealCell(firstRow, firstCol);
+    int clicks = 1;
+    int guesses = 0;
+    while (!engine.isGameOver()) {
+        const BotPolicy::Move move = worker.bot->nextMove(engine, rng);
+        engine.clearChanges();
+        engine.revealCell(move.index / difficulty.cols, move.index % difficulty.cols);
+        ++clicks;
+        guesses += move.guess ? 1 : 0;
+    }
+    stats.playTime.add(Simulator::timeBucket(elapsedNs(playStarted)));
+
+    stats.games++;
+    stats.wins += engine.isGameWon() ? 1 : 0;
+    stats.clicks += clicks;
+    stats.guesses += guesses;
+    stats.guessCounts.add(guesses);
+}
+
+} // namespace
+
+void Simulator::Histogram::add(int value)
+{
+    value = std::max(0, value);
+    if (value >= static_cast<int>(counts.size())) {
+        counts.resize(value + 1, 0);
+    }
+    counts[value]++;
+}
+
+void Simulator::Histogram::merge(const Histogram &other)
+{
+    if (other.counts.size() > counts.size()) {
+        counts.resize(other.counts.size(), 0);
+    }
+    for (size_t i = 0; i < other.counts.size(); ++i) {
+        counts[i] += other.counts[i];
+    }
+}
+
+long long Simulator::Histogram::total() const
+{
+    long long sum = 0;
+    for (long long count : counts) {
+        sum += count;
+    }
+    return sum;
+}
+
+int Simulator::Histogram::percentile(double p) const
+{
+    const long long all = total();
+    if (all == 0) {
+        return 0;
+    }
+    // 最小的 v，使得不大于 v 的样本数达到总数的 p
+    const long long rank = std::max(1LL, static_cast<long long>(std::ceil(p * all)));
+    long long seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return static_cast<int>(i);
+        }
+    }
+    return static_cast<int>(counts.size()) - 1;
+}
+
+void Simulator::Stats::merge(const Stats &other)
+{
+    games += other.games;
+    wins += other.wins;
+    guesses += other.guesses;
+    clicks += other.clicks;
+    noGuessFailures += other.noGuessFailures;
+    bbbv.merge(other.bbbv);
+    guessCounts.merge(other.guessCounts);
+    generateTime.merge(other.generateTime);
+    playTime.merge(other.playTime);
+}
+
+std::uint64_t Simulator::gameSeed(std::uint64_t masterSeed, long long index)
+{
+    return mix64(masterSeed + 0x9E3779B97F4A7C15ULL * static_cast<std::uint64_t>(index + 1));
+}
+
+int Simulator::timeBucket(double ns)
+{
+    return ns < 1 ? 0 : static_cast<int>(std::log2(ns) * 4);
+}
+
+double Simulator::bucketMicros(int bucket)
+{
+    return std::exp2(bucket / 4.0) / 1000;
+}
+
+bool Simulator::parseDifficulty(const std::string &text, Difficulty *difficulty)
+{
+    if (text == "beginner") {
+        *difficulty = {text, 9, 9, 10};
+        return true;
+    }
+    if (text == "intermediate") {
+        *difficulty = {text, 16, 16, 40};
+        return true;
+    }
+    if (text == "expert") {
+        *difficulty = {text, 16, 30, 99};
+        return true;
+    }
+
+    int rows = 0;
+    int cols = 0;
+    int mines = 0;
+    char tail = 0;
+    if (std::sscanf(text.c_str(), "%dx%d/%d%c", &rows, &cols, &mines, &tail) != 3) {
+        return false;
+    }
+    // 与 placeMines 的约束一致：首次点击的3x3安全区外要放得下全部地雷
+    if (rows <= 0 || cols <= 0 || mines < 0 || static_cast<long long>(rows) * cols > 1LL << 30
+        || mines > rows * cols - 9) {
+        return false;
+    }
+    *difficulty = {text, rows, cols, mines};
+    return true;
+}
+
+std::vector<Simulator::Stats> Simulator::run()
+{
+    if (!BotPolicy::create(m_options.bot)) {
+        return {};
+    }
+    m_threadCount = m_options.threads > 0 ? m_options.threads
+                                          : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    const int difficulties = static_cast<int>(m_options.difficulties.size());
+
+    // 棋盘库的记录长度按最大的难度确定
+    std::unique_ptr<CorpusSink> corpus;
+    if (!m_options.corpus.empty()) {
+        int maxCells = 0;
+        for (const Difficulty &difficulty : m_options.difficulties) {
+            maxCells = std::max(maxCells, difficulty.rows * difficulty.cols);
+        }
+        corpus.reset(new CorpusSink);
+        if (!corpus->writer.open(m_options.corpus, maxCells)) {
+            return {};
+        }
+    }
+
+    // 任务按顺序分成连续的块，轮流分配给各个线程的队列
+    TaskQueues queues(m_threadCount);
+    int target = 0;
+    for (int d = 0; d < difficulties; ++d) {
+        for (long long first = 0; first < m_options.games; first += ChunkGames) {
+            queues.push(target, {d, first, std::min(ChunkGames, m_options.games - first)});
+            target = (target + 1) % m_threadCount;
+        }
+    }
+
+    std::vector<Worker> workers(m_threadCount);
+    for (Worker &worker : workers) {
+        worker.bot = BotPolicy::create(m_options.bot);
+        worker.stats.resize(difficulties);
+    }
+
+    const auto started = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    threads.reserve(m_threadCount);
+    for (int t = 0; t < m_threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            Task task;
+            while (queues.pop(t, &task)) {
+                for (long long i = 0; i < task.count; ++i) {
+                    playGame(m_options, task.difficulty, task.first + i, workers[t], corpus.get());
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    m_elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    if (corpus) {
+        m_corpusBoards = corpus->writer.written();
+        if (!corpus->writer.close() || !BoardCorpus::buildIndex(m_options.corpus)) {
+            return {};
+        }
+    }
+
+    // 计数和直方图的合并与顺序无关，结果不受窃取顺序影响
+    std::vector<Stats> result(difficulties);
+    for (int d = 0; d < difficulties; ++d) {
+        result[d].difficulty = m_options.difficulties[d];
+        for (const Worker &worker : workers) {
+            result[d].merge(worker.stats[d]);
+        }
+    }
+    return result;
+}
+
+void Simulator::writeCsv(std::ostream &out, const std::vector<Stats> &stats) const
+{
+    out << "difficulty,rows,cols,mines,bot,no_guess,games,wins,win_rate,guesses_per_game,"
+           "zero_guess_games,clicks_per_game,bbbv_mean,bbbv_p50,bbbv_p90,"
+           "generate_us_p50,generate_us_p99,play_us_p50,play_us_p90,play_us_p99,noguess_failures\n";
+    char line[512];
+    for (const Stats &s : stats) {
+        const double games = std::max(1LL, s.games);
+        double bbbvSum = 0;
+        for (size_t v = 0; v < s.bbbv.counts.size(); ++v) {
+            bbbvSum += static_cast<double>(v) * s.bbbv.counts[v];
+        }
+        const long long zeroGuess = s.guessCounts.counts.empty() ? 0 : s.guessCounts.counts[0];
+        std::snprintf(line, sizeof(line),
+                      "%s,%d,%d,%d,%s,%d,%lld,%lld,%.6f,%.4f,%lld,%.2f,%.2f,%d,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%lld\n",
+                      s.difficulty.name.c_str(), s.difficulty.rows, s.difficulty.cols, s.difficulty.mines,
+                      m_options.bot.c_str(), m_options.noGuess ? 1 : 0, s.games, s.wins, s.wins / games,
+                      s.guesses / games, zeroGuess, s.clicks / games, bbbvSum / games,
+                      s.bbbv.percentile(0.5), s.bbbv.percentile(0.9),
+                      bucketMicros(s.generateTime.percentile(0.5)), bucketMicros(s.generateTime.percentile(0.99)),
+                      bucketMicros(s.playTime.percentile(0.5)), bucketMicros(s.playTime.percentile(0.9)),
+                      bucketMicros(s.playTime.percentile(0.99)), s.noGuessFailures);
+        out << line;
+    }
+}
+
+void Simulator::writeJson(std::ostream &out, const std::vector<Stats> &stats) const
+{
+    char buffer[256];
+    auto histogram = [&](const Histogram &h) {
+        out << "[";
+        for (size_t i = 0; i < h.counts.size(); ++i) {
+            out << (i ? ", " : "") << h.counts[i];
+        }
+        out << "]";
+    };
+    // 耗时直方图只输出非空的桶：[下界微秒, 次数]
+    auto timeHistogram = [&](const Histogram &h) {
+        out << "[";
+        bool first = true;
+        for (size_t i = 0; i < h.counts.size(); ++i) {
+            if (!h.counts[i]) {
+                continue;
+            }
+            std::snprintf(buffer, sizeof(buffer), "%s[%.3f, %lld]", first ? "" : ", ",
+                          bucketMicros(static_cast<int>(i)), h.counts[i]);
+            out << buffer;
+            first = false;
+        }
+        out << "]";
+    };
+
+    std::snprintf(buffer, sizeof(buffer), "%.3f", m_elapsedSeconds);
+    out << "{\n  \"bot\": \"" << m_options.bot << "\",\n  \"seed\": " << m_options.seed
+        << ",\n  \"threads\": " << m_threadCount << ",\n  \"no_guess\": " << (m_options.noGuess ? "true" : "false")
+        << ",\n  \"elapsed_s\": " << buffer << ",\n  \"difficulties\": [\n";
+    for (size_t d = 0; d < stats.size(); ++d) {
+        const Stats &s = stats[d];
+        const double games = std::max(1LL, s.games);
+        std::snprintf(buffer, sizeof(buffer), "\"win_rate\": %.6f, \"guesses_per_game\": %.4f, \"clicks_per_game\": %.2f",
+                      s.wins / games, s.guesses / games, s.clicks / games);
+        out << "    {\"name\": \"" << s.difficulty.name << "\", \"rows\": " << s.difficulty.rows
+            << ", \"cols\": " << s.difficulty.cols << ", \"mines\": " << s.difficulty.mines
+            << ", \"games\": " << s.games << ", \"wins\": " << s.wins << ", " << buffer
+            << ", \"noguess_failures\": " << s.noGuessFailures << ",\n     \"bbbv\": ";
+        histogram(s.bbbv);
+        out << ",\n     \"guesses\": ";
+        histogram(s.guessCounts);
+        out << ",\n     \"generate_us\": ";
+        timeHistogram(s.generateTime);
+        out << ",\n     \"play_us\": ";
+        timeHistogram(s.playTime);
+        out << "}" << (d + 1 < stats.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+}
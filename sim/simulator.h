@@ -0,0 +1,86 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 无界面的批量对局模拟：在多个工作线程上用指定的机器人策略下大量对局，
+// 统计胜率、猜测次数、3BV 和耗时分布。
+// 每局的种子只由主种子和对局序号决定，统计结果（耗时除外）与线程数、
+// 任务被哪个线程窃取都无关
+class Simulator
+{
+public:
+    struct Difficulty {
+        std::string name;
+        int rows;
+        int cols;
+        int mines;
+    };
+
+    struct Options {
+        std::vector<Difficulty> difficulties;
+        long long games = 10000; // 每种难度的对局数
+        int threads = 0;         // 0 表示硬件线程数
+        std::uint64_t seed = 1;
+        std::string bot = "solver";
+        bool noGuess = false;    // 用无猜生成器出题
+        std::string corpus;      // 非空时把出的题追加到这个棋盘库并重建索引（无猜模式只收录验证通过的）
+    };
+
+    // 按值计数的直方图，用于求分位数
+    struct Histogram {
+        std::vector<long long> counts;
+
+        void add(int value);
+        void merge(const Histogram &other);
+        long long total() const;
+        int percentile(double p) const;
+    };
+
+    struct Stats {
+        Difficulty difficulty;
+        long long games = 0;
+        long long wins = 0;
+        long long guesses = 0;
+        long long clicks = 0;
+        long long noGuessFailures = 0; // 无猜生成达到候选上限，退回普通棋盘
+        Histogram bbbv;                // 3BV
+        Histogram guessCounts;         // 每局猜测次数
+        Histogram generateTime;        // 出题耗时，对数桶（见 timeBucket）
+        Histogram playTime;            // 对局耗时，对数桶
+
+        void merge(const Stats &other);
+    };
+
+    explicit Simulator(const Options &options) : m_options(options) {}
+
+    // 运行全部对局，返回每种难度的统计；策略名称无效或棋盘库无法写入时返回空
+    std::vector<Stats> run();
+    double elapsedSeconds() const { return m_elapsedSeconds; }
+    int threadCount() const { return m_threadCount; }
+    long long corpusBoards() const { return m_corpusBoards; }
+
+    void writeCsv(std::ostream &out, const std::vector<Stats> &stats) const;
+    void writeJson(std::ostream &out, const std::vector<Stats> &stats) const;
+
+    // 解析 beginner / intermediate / expert 或 RxC/M
+    static bool parseDifficulty(const std::string &text, Difficulty *difficulty);
+
+    // 第 index 局的种子
+    static std::uint64_t gameSeed(std::uint64_t masterSeed, long long index);
+
+    // 耗时（纳秒）与对数桶的换算：每个2的幂分成4个桶，误差不超过19%
+    static int timeBucket(double ns);
+    static double bucketMicros(int bucket);
+
+private:
+    Options m_options;
+    double m_elapsedSeconds = 0;
+    int m_threadCount = 0;
+    long long m_corpusBoards = 0;
+};
+
+#endif // SIMULATOR_H
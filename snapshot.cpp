@@ -0,0 +1,123 @@
+#include "snapshot.h"
+#include "adjacency.h"
+#include "trace.h"
+#include <cstring>
+
+namespace {
+
+const char Magic[4] = {'M', 'S', 'S', 'V'};
+
+enum HeaderFlags : std::uint32_t {
+    MinesPlacedFlag = 1
+};
+
+// 定长头部，大小是8的倍数，之后的各段保持对齐
+struct Header {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t rows;
+    std::uint32_t cols;
+    std::uint32_t mineCount;        // 引擎的地雷数，布雷后即实际数量
+    std::uint32_t mineCountSetting;
+    std::int64_t elapsedMs;
+    std::uint32_t flags;
+    std::uint32_t wordsPerRow;
+    std::uint64_t replayBytes;
+};
+static_assert(sizeof(Header) % 8 == 0, "snapshot sections must stay 8-byte aligned");
+
+inline std::size_t paddedTo8(std::size_t bytes)
+{
+    return (bytes + 7) & ~std::size_t(7);
+}
+
+} // namespace
+
+std::vector<std::uint8_t> GameSnapshot::save(const BoardEngine &engine, const Info &info, const Replay &replay)
+{
+    TRACE_SPAN("GameSnapshot::save");
+    const std::vector<std::uint8_t> replayData = replay.serialize();
+    const bool minesPlaced = engine.minesPlaced();
+    const std::size_t planeWords = minesPlaced ? engine.minePlanes().size() : 0;
+    const std::size_t visibleWords = BoardEngine::visibleWords(engine.cellCount());
+
+    Header header;
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.rows = static_cast<std::uint32_t>(engine.rows());
+    header.cols = static_cast<std::uint32_t>(engine.cols());
+    header.mineCount = static_cast<std::uint32_t>(engine.mineCount());
+    header.mineCountSetting = static_cast<std::uint32_t>(info.mineCountSetting);
+    header.elapsedMs = info.elapsedMs;
+    header.flags = minesPlaced ? std::uint32_t(MinesPlacedFlag) : 0u;
+    header.wordsPerRow = static_cast<std::uint32_t>(engine.wordsPerRow());
+    header.replayBytes = replayData.size();
+
+    // 一次分配好整块缓冲区，各段直接写入其中
+    std::vector<std::uint8_t> out(sizeof(Header) + (planeWords + visibleWords) * 8
+                                  + paddedTo8(replayData.size()));
+    std::uint8_t *data = out.data();
+    std::memcpy(data, &header, sizeof(Header));
+    data += sizeof(Header);
+    if (planeWords) {
+        std::memcpy(data, engine.minePlanes().data(), planeWords * 8);
+        data += planeWords * 8;
+    }
+    engine.packVisible(reinterpret_cast<std::uint64_t *>(data));
+    data += visibleWords * 8;
+    if (!replayData.empty()) {
+        std::memcpy(data, replayData.data(), replayData.size());
+    }
+    return out;
+}
+
+bool GameSnapshot::load(const std::uint8_t *data, std::size_t size, BoardEngine *engine, Info *info,
+                        Replay *replay)
+{
+    TRACE_SPAN("GameSnapshot::load");
+    if (size < sizeof(Header) || reinterpret_cast<std::uintptr_t>(data) % 8 != 0) {
+        return false;
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+    const std::uint64_t cells = static_cast<std::uint64_t>(header.rows) * header.cols;
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version
+        || header.rows == 0 || header.cols == 0 || cells > (1u << 30) || header.mineCount > cells
+        || header.mineCountSetting > cells || header.elapsedMs < 0
+        || header.wordsPerRow != static_cast<std::uint32_t>(Adjacency::wordsPerRow(header.cols))) {
+        return false;
+    }
+
+    // 按头部算出各段的位置，长度必须与文件完全一致
+    const bool minesPlaced = header.flags & MinesPlacedFlag;
+    const std::uint64_t planeWords = minesPlaced ? std::uint64_t(header.rows) * header.wordsPerRow : 0;
+    const std::uint64_t visibleWords = BoardEngine::visibleWords(static_cast<int>(cells));
+    const std::uint64_t boardBytes = sizeof(Header) + (planeWords + visibleWords) * 8;
+    // 先确认录像长度不超过剩余部分再补齐，否则接近 UINT64_MAX 的长度补齐后会回绕
+    if (boardBytes > size || header.replayBytes > size - boardBytes
+        || paddedTo8(header.replayBytes) != size - boardBytes) {
+        return false;
+    }
+    const std::uint64_t *planes = reinterpret_cast<const std::uint64_t *>(data + sizeof(Header));
+    const std::uint64_t *visible = planes + planeWords;
+
+    Replay loadedReplay;
+    if (!loadedReplay.deserialize(data + boardBytes, static_cast<std::size_t>(header.replayBytes))
+        || loadedReplay.rows() != static_cast<int>(header.rows)
+        || loadedReplay.cols() != static_cast<int>(header.cols)) {
+        return false;
+    }
+
+    BoardEngine board;
+    if (!board.restore(static_cast<int>(header.rows), static_cast<int>(header.cols),
+                       static_cast<int>(header.mineCount), minesPlaced, planes, visible)
+        || board.mineCount() != static_cast<int>(header.mineCount)) {
+        return false;
+    }
+
+    *engine = std::move(board);
+    *replay = std::move(loadedReplay);
+    info->mineCountSetting = static_cast<int>(header.mineCountSetting);
+    info->elapsedMs = header.elapsedMs;
+    return true;
+}
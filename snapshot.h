@@ -0,0 +1,34 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "boardengine.h"
+#include "replay.h"
+
+// 进行中对局的存档：定长头部，之后依次是地雷行位平面、每格2位的可见状态
+// 和本局录像。各段都按8字节对齐，读取时直接在映射的文件上使用位平面，
+// 不做逐格解析；相邻计数、标记数和胜负在加载时重新推出。
+// 整数按本机字节序（小端）存储
+class GameSnapshot
+{
+public:
+    static const std::uint32_t Version = 1;
+
+    // 引擎之外需要恢复的对局状态
+    struct Info {
+        int mineCountSetting = 0; // 玩家设置的地雷数
+        std::int64_t elapsedMs = 0;
+    };
+
+    // 序列化为一块连续的缓冲区，调用方一次写入文件
+    static std::vector<std::uint8_t> save(const BoardEngine &engine, const Info &info, const Replay &replay);
+
+    // 从 data 恢复，data 必须按8字节对齐（映射的文件总是满足）。
+    // 失败时返回 false，engine、info 和 replay 都不变
+    static bool load(const std::uint8_t *data, std::size_t size, BoardEngine *engine, Info *info,
+                     Replay *replay);
+};
+
+#endif // SNAPSHOT_H
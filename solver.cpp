@@ -0,0 +1,259 @@
+#include "solver.h"
+#include "trace.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+using Constraint = Solver::Constraint;
+
+// 从约束中去掉已推出的单元格，得到新的约束；矛盾（例如错误的标记）时返回 false
+bool reduce(const Constraint &source, const std::unordered_map<int, bool> &known, Constraint *out)
+{
+    out->cell = source.cell;
+    out->mines = source.mines;
+    out->unknownCount = 0;
+    for (int i = 0; i < source.unknownCount; ++i) {
+        const auto it = known.find(source.unknowns[i]);
+        if (it == known.end()) {
+            out->unknowns[out->unknownCount++] = source.unknowns[i];
+        } else if (it->second) {
+            out->mines--;
+        }
+    }
+    return out->mines >= 0 && out->mines <= out->unknownCount;
+}
+
+} // namespace
+
+bool Solver::isUnknown(int index) const
+{
+    const std::uint8_t state = m_engine.cells()[index];
+    return !(state & (BoardEngine::RevealedBit | BoardEngine::FlaggedBit));
+}
+
+bool Solver::isFrontierCell(int index) const
+{
+    const std::uint8_t state = m_engine.cells()[index];
+    if ((state & (BoardEngine::RevealedBit | BoardEngine::MineBit)) != BoardEngine::RevealedBit
+        || !(state & BoardEngine::CountMask)) {
+        return false;
+    }
+
+    const int rows = m_engine.rows();
+    const int cols = m_engine.cols();
+    const int r = index / cols;
+    const int c = index % cols;
+    for (int nr = std::max(r - 1, 0); nr <= std::min(r + 1, rows - 1); ++nr) {
+        for (int nc = std::max(c - 1, 0); nc <= std::min(c + 1, cols - 1); ++nc) {
+            if (isUnknown(nr * cols + nc)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Solver::touch(int index)
+{
+    std::uint64_t &word = m_frontierBits[index / 64];
+    const std::uint64_t bit = std::uint64_t(1) << (index % 64);
+    if (!(word & bit) && isFrontierCell(index)) {
+        word |= bit;
+        m_frontier.push_back(index);
+    }
+}
+
+void Solver::rebuild()
+{
+    m_frontier.clear();
+    m_frontierBits.assign((m_engine.cellCount() + 63) / 64, 0);
+    for (int i = 0; i < m_engine.cellCount(); ++i) {
+        touch(i);
+    }
+}
+
+void Solver::setFrontier(const std::vector<int> &frontier)
+{
+    m_frontier.clear();
+    m_frontierBits.assign((m_engine.cellCount() + 63) / 64, 0);
+    for (int index : frontier) {
+        if (index >= 0 && index < m_engine.cellCount()) {
+            touch(index);
+        }
+    }
+}
+
+void Solver::update(const BoardEngine::ChangeSet &changes)
+{
+    if (changes.fullUpdate || m_frontierBits.size() != static_cast<size_t>((m_engine.cellCount() + 63) / 64)) {
+        rebuild();
+        return;
+    }
+
+    // 揭开或取消标记都可能让单元格及其邻居重新加入前沿（取消标记后周围的数字
+    // 又有了未知格，撤销时揭开的格子也会变回未知）；离开前沿的单元格留到求解时清理
+    const int rows = m_engine.rows();
+    const int cols = m_engine.cols();
+    for (const BoardEngine::CellChange &change : changes.cells) {
+        if (!((change.oldState ^ change.newState) & (BoardEngine::RevealedBit | BoardEngine::FlaggedBit))) {
+            continue;
+        }
+        const int r = change.index / cols;
+        const int c = change.index % cols;
+        for (int nr = std::max(r - 1, 0); nr <= std::min(r + 1, rows - 1); ++nr) {
+            for (int nc = std::max(c - 1, 0); nc <= std::min(c + 1, cols - 1); ++nc) {
+                touch(nr * cols + nc);
+            }
+        }
+    }
+}
+
+bool Solver::buildConstraint(int cell, Constraint *constraint) const
+{
+    const int rows = m_engine.rows();
+    const int cols = m_engine.cols();
+    const int r = cell / cols;
+    const int c = cell % cols;
+
+    constraint->cell = cell;
+    constraint->mines = m_engine.cells()[cell] & BoardEngine::CountMask;
+    constraint->unknownCount = 0;
+    for (int nr = std::max(r - 1, 0); nr <= std::min(r + 1, rows - 1); ++nr) {
+        for (int nc = std::max(c - 1, 0); nc <= std::min(c + 1, cols - 1); ++nc) {
+            const int neighbour = nr * cols + nc;
+            const std::uint8_t state = m_engine.cells()[neighbour];
+            if (state & BoardEngine::FlaggedBit) {
+                constraint->mines--;
+            } else if (!(state & BoardEngine::RevealedBit)) {
+                constraint->unknowns[constraint->unknownCount++] = neighbour;
+            }
+        }
+    }
+    return constraint->unknownCount > 0;
+}
+
+const Solver::Result &Solver::solve()
+{
+    TRACE_SPAN("Solver::solve");
+    m_result.safeCells.clear();
+    m_result.mineCells.clear();
+    m_constraints.clear();
+
+    // 清理已离开前沿的单元格，排序后求解结果与更新顺序无关
+    auto out = m_frontier.begin();
+    for (int cell : m_frontier) {
+        if (isFrontierCell(cell)) {
+            *out++ = cell;
+        } else {
+            m_frontierBits[cell / 64] &= ~(std::uint64_t(1) << (cell % 64));
+        }
+    }
+    m_frontier.erase(out, m_frontier.end());
+    std::sort(m_frontier.begin(), m_frontier.end());
+
+    std::unordered_map<int, int> constraintOf;
+    constraintOf.reserve(m_frontier.size());
+    for (int cell : m_frontier) {
+        Constraint constraint;
+        if (buildConstraint(cell, &constraint)) {
+            constraintOf.emplace(cell, static_cast<int>(m_constraints.size()));
+            m_constraints.push_back(constraint);
+        }
+    }
+
+    std::unordered_map<int, bool> known;
+    bool progress = true;
+    auto conclude = [&](const int *cells, int count, bool mine) {
+        for (int i = 0; i < count; ++i) {
+            if (known.emplace(cells[i], mine).second) {
+                progress = true;
+            }
+        }
+    };
+
+    const int cols = m_engine.cols();
+    std::vector<Constraint> reduced(m_constraints.size());
+    std::vector<char> valid(m_constraints.size());
+    while (progress) {
+        progress = false;
+        for (size_t i = 0; i < m_constraints.size(); ++i) {
+            valid[i] = reduce(m_constraints[i], known, &reduced[i]);
+        }
+
+        // 单格规则
+        for (size_t i = 0; i < reduced.size(); ++i) {
+            const Constraint &a = reduced[i];
+            if (!valid[i] || a.unknownCount == 0) {
+                continue;
+            }
+            if (a.mines == 0) {
+                conclude(a.unknowns, a.unknownCount, false);
+            } else if (a.mines == a.unknownCount) {
+                conclude(a.unknowns, a.unknownCount, true);
+            }
+        }
+        if (progress) {
+            continue;
+        }
+
+        // 成对规则：只有相距不超过2格的数字格才可能共享未知格。
+        // 设 A、B 的独有部分为 onlyA、onlyB，则 mines(onlyB) - mines(onlyA) = B.mines - A.mines，
+        // 差值等于 |onlyB| 时 onlyB 全是地雷且 onlyA 全部安全（子集规则是 onlyA 为空的特例）
+        for (size_t i = 0; i < reduced.size(); ++i) {
+            const Constraint &a = reduced[i];
+            if (!valid[i] || a.unknownCount == 0) {
+                continue;
+            }
+            const int r = a.cell / cols;
+            const int c = a.cell % cols;
+            for (int dr = -2; dr <= 2; ++dr) {
+                for (int dc = -2; dc <= 2; ++dc) {
+                    if (c + dc < 0 || c + dc >= cols) {
+                        continue;
+                    }
+                    const auto it = constraintOf.find((r + dr) * cols + c + dc);
+                    if (it == constraintOf.end() || it->second <= static_cast<int>(i) || !valid[it->second]) {
+                        continue;
+                    }
+                    const Constraint &b = reduced[it->second];
+
+                    int onlyA[8], onlyB[8];
+                    int onlyACount = 0, onlyBCount = 0, shared = 0;
+                    for (int x = 0; x < a.unknownCount; ++x) {
+                        if (std::find(b.unknowns, b.unknowns + b.unknownCount, a.unknowns[x])
+                            == b.unknowns + b.unknownCount) {
+                            onlyA[onlyACount++] = a.unknowns[x];
+                        } else {
+                            shared++;
+                        }
+                    }
+                    if (shared == 0) {
+                        continue;
+                    }
+                    for (int y = 0; y < b.unknownCount; ++y) {
+                        if (std::find(a.unknowns, a.unknowns + a.unknownCount, b.unknowns[y])
+                            == a.unknowns + a.unknownCount) {
+                            onlyB[onlyBCount++] = b.unknowns[y];
+                        }
+                    }
+
+                    if (b.mines - a.mines == onlyBCount) {
+                        conclude(onlyB, onlyBCount, true);
+                        conclude(onlyA, onlyACount, false);
+                    } else if (a.mines - b.mines == onlyACount) {
+                        conclude(onlyA, onlyACount, true);
+                        conclude(onlyB, onlyBCount, false);
+                    }
+                }
+            }
+        }
+    }
+
+    for (const auto &entry : known) {
+        (entry.second ? m_result.mineCells : m_result.safeCells).push_back(entry.first);
+    }
+    std::sort(m_result.safeCells.begin(), m_result.safeCells.end());
+    std::sort(m_result.mineCells.begin(), m_result.mineCells.end());
+    return m_result;
+}
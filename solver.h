@@ -0,0 +1,65 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <cstdint>
+#include <vector>
+#include "boardengine.h"
+
+// 确定性的约束传播求解器，只使用玩家可见的信息：已揭开的数字和标记
+// （标记视为地雷）。前沿是周围还有未知单元格的已揭开数字格，
+// 由 update() 根据每次的变更集增量维护，求解开销只与前沿大小有关。
+// 规则：单格规则（剩余地雷为0或等于未知格数），以及相邻两个约束之间的
+// 子集/超集规则；推出的结论代回约束反复传播直到不再变化
+class Solver
+{
+public:
+    // 一个数字格给出的约束：unknowns 中恰好有 mines 个地雷
+    struct Constraint {
+        int cell;
+        int mines;
+        int unknownCount;
+        int unknowns[8]; // 升序
+    };
+
+    struct Result {
+        std::vector<int> safeCells; // 可以证明安全的单元格，升序
+        std::vector<int> mineCells; // 可以证明是地雷的单元格，升序
+    };
+
+    explicit Solver(const BoardEngine &engine) : m_engine(engine) {}
+
+    // 扫描整个棋盘重建前沿（引擎重置或布雷之后）
+    void rebuild();
+
+    // 根据变更集更新前沿，fullUpdate 时退化为 rebuild()
+    void update(const BoardEngine::ChangeSet &changes);
+
+    // 增量维护的前沿（可能含已离开前沿、求解时才清理的单元格）。
+    // 把它交给同一局面快照上的求解器代替 rebuild()，开销只与前沿有关
+    const std::vector<int> &frontier() const { return m_frontier; }
+    void setFrontier(const std::vector<int> &frontier);
+
+    // 求解当前局面，返回的引用在下一次求解之前有效
+    const Result &solve();
+
+    // 最近一次求解使用的约束（已代入求解前已知的标记），按单元格下标升序
+    const std::vector<Constraint> &constraints() const { return m_constraints; }
+    int frontierSize() const { return static_cast<int>(m_frontier.size()); }
+
+private:
+    const BoardEngine &m_engine;
+
+    // 前沿单元格及其成员位图；不再属于前沿的单元格在求解时才移除
+    std::vector<int> m_frontier;
+    std::vector<std::uint64_t> m_frontierBits;
+
+    std::vector<Constraint> m_constraints;
+    Result m_result;
+
+    bool isUnknown(int index) const;
+    bool isFrontierCell(int index) const;
+    void touch(int index);
+    bool buildConstraint(int cell, Constraint *constraint) const;
+};
+
+#endif // SOLVER_H
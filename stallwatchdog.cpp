@@ -0,0 +1,50 @@
+#include "stallwatchdog.h"
+#include "trace.h"
+#include <QAbstractEventDispatcher>
+
+StallWatchdog::StallWatchdog(QObject *parent) : QObject(parent)
+{
+}
+
+void StallWatchdog::setEnabled(bool enabled)
+{
+    if (enabled == m_enabled) {
+        return;
+    }
+    m_enabled = enabled;
+    m_busySince = -1;
+
+    if (!enabled) {
+        disconnect(m_awakeConnection);
+        disconnect(m_blockConnection);
+        return;
+    }
+    QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance(thread());
+    if (!dispatcher) {
+        return;
+    }
+    m_awakeConnection = connect(dispatcher, &QAbstractEventDispatcher::awake, this, &StallWatchdog::onAwake,
+                                Qt::DirectConnection);
+    m_blockConnection = connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, this,
+                                &StallWatchdog::onAboutToBlock, Qt::DirectConnection);
+}
+
+void StallWatchdog::onAwake()
+{
+    // 一次忙碌期内可能多次被唤醒，只记第一次
+    if (m_busySince < 0) {
+        m_busySince = Trace::now();
+    }
+}
+
+void StallWatchdog::onAboutToBlock()
+{
+    if (m_busySince < 0) {
+        return;
+    }
+    const std::int64_t busy = Trace::now() - m_busySince;
+    if (busy > Trace::StallThresholdNs) {
+        Trace::stall(m_busySince, busy);
+    }
+    m_busySince = -1;
+}
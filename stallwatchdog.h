@@ -0,0 +1,30 @@
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QObject>
+#include <cstdint>
+
+// 事件循环卡顿监测：开启时连接当前线程事件分发器的 awake/aboutToBlock 信号，
+// 两者之间的忙碌期超过一帧（Trace::StallThresholdNs）就记为一次卡顿，
+// 原因取这段时间内最长的跟踪区间。关闭时断开连接，没有任何开销
+class StallWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StallWatchdog(QObject *parent = nullptr);
+
+    void setEnabled(bool enabled);
+    bool isEnabled() const { return m_enabled; }
+
+private:
+    bool m_enabled = false;
+    std::int64_t m_busySince = -1; // 本次被唤醒的时间，阻塞等待时为 -1
+    QMetaObject::Connection m_awakeConnection;
+    QMetaObject::Connection m_blockConnection;
+
+    void onAwake();
+    void onAboutToBlock();
+};
+
+#endif // STALLWATCHDOG_H
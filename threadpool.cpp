@@ -0,0 +1,101 @@
+#include "threadpool.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(int threads)
+{
+    if (threads <= 0) {
+        threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    m_workers.reserve(threads);
+    for (int i = 0; i < threads; ++i) {
+        m_workers.emplace_back([this] { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wakeup.notify_all();
+    for (std::thread &worker : m_workers) {
+        worker.join();
+    }
+}
+
+ThreadPool &ThreadPool::global()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push_back(std::move(task));
+    }
+    m_wakeup.notify_one();
+}
+
+void ThreadPool::workerLoop()
+{
+    Trace::setThreadName("ThreadPool");
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeup.wait(lock, [this] { return m_stopping || !m_tasks.empty(); });
+            if (m_tasks.empty()) {
+                return; // 停止时先把队列中的任务做完
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)> &fn)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    // 共享状态由辅助任务共同持有：调用方返回后才开始运行的辅助任务
+    // 只会发现没有剩余下标，不会再访问 fn
+    struct State {
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        const std::function<void(int)> *fn;
+        int count;
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto state = std::make_shared<State>();
+    state->fn = &fn;
+    state->count = count;
+
+    auto drain = [](State &s) {
+        for (int i = s.next.fetch_add(1); i < s.count; i = s.next.fetch_add(1)) {
+            (*s.fn)(i);
+            if (s.done.fetch_add(1) + 1 == s.count) {
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.finished.notify_all();
+            }
+        }
+    };
+
+    const int helpers = std::min(count - 1, threadCount());
+    for (int i = 0; i < helpers; ++i) {
+        submit([state, drain] { drain(*state); });
+    }
+    drain(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&] { return state->done.load() == count; });
+}
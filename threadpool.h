@@ -0,0 +1,44 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定大小的工作线程池，供引擎库中的并行计算使用，不依赖 Qt
+class ThreadPool
+{
+public:
+    // threads 为0时使用硬件线程数
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int threadCount() const { return static_cast<int>(m_workers.size()); }
+
+    // 提交一个后台任务，不等待完成
+    void submit(std::function<void()> task);
+
+    // 并行执行 fn(0) ... fn(count - 1)，全部完成后返回。
+    // 调用线程也领取任务，因此在工作线程内嵌套调用不会死锁
+    void parallelFor(int count, const std::function<void(int)> &fn);
+
+    // 进程内共享的线程池
+    static ThreadPool &global();
+
+private:
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_tasks;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeup;
+    bool m_stopping = false;
+
+    void workerLoop();
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,147 @@
+#include "tileatlas.h"
+#include "boardengine.h"
+#include <QPainter>
+#include <QtMath>
+
+namespace {
+
+// 数字颜色，与原来按钮样式表中的颜色一致
+QColor numberColor(int count)
+{
+    switch (count) {
+        case 1: return QColor("#1976D2"); // Blue
+        case 2: return QColor("#388E3C"); // Green
+        case 3: return QColor("#D32F2F"); // Red
+        case 4: return QColor("#7B1FA2"); // Purple
+        case 5: return QColor("#FF8F00"); // Orange
+        case 6: return QColor("#0097A7"); // Cyan
+        case 7: return QColor("#424242"); // Dark Gray
+        case 8: return QColor("#9E9E9E"); // Gray
+    }
+    return Qt::black;
+}
+
+} // namespace
+
+bool TileAtlas::ensure(int cellSize, qreal devicePixelRatio)
+{
+    if (cellSize == m_cellSize && qFuzzyCompare(devicePixelRatio, m_devicePixelRatio)
+        && !m_pixmap.isNull()) {
+        return false;
+    }
+
+    m_cellSize = cellSize;
+    m_devicePixelRatio = devicePixelRatio;
+    m_tilePixels = qMax(1, qCeil(cellSize * devicePixelRatio));
+
+    // 图集按设备像素存储，每块贴图在自己的位置上按像素比缩放后绘制，
+    // 绘制时用设备像素的源矩形取图
+    m_pixmap = QPixmap(m_tilePixels * TileCount, m_tilePixels);
+    m_pixmap.fill(Qt::transparent);
+
+    QPainter painter(&m_pixmap);
+    painter.setRenderHint(QPainter::TextAntialiasing);
+    QFont font = painter.font();
+    font.setBold(true);
+    font.setPixelSize(qMax(1, qMin(14, cellSize * 7 / 10)));
+    painter.setFont(font);
+
+    for (int tile = 0; tile < TileCount; ++tile) {
+        painter.save();
+        painter.translate(tile * m_tilePixels, 0);
+        painter.scale(devicePixelRatio, devicePixelRatio);
+        paintTile(painter, static_cast<Tile>(tile), QRect(0, 0, cellSize, cellSize));
+        painter.restore();
+    }
+    return true;
+}
+
+TileAtlas::Tile TileAtlas::tileFor(std::uint8_t state, bool hover)
+{
+    if (state & BoardEngine::FlaggedBit) {
+        return Flag;
+    }
+    if (!(state & BoardEngine::RevealedBit)) {
+        return hover ? Hover : Hidden;
+    }
+    if (state & BoardEngine::MineBit) {
+        return Mine;
+    }
+    const int count = state & BoardEngine::CountMask;
+    return count > 0 ? static_cast<Tile>(Number1 + count - 1) : Blank;
+}
+
+QRgb TileAtlas::coarseColor(Tile tile)
+{
+    switch (tile) {
+    case Hidden:
+    case Hover:
+        return qRgb(0xC8, 0xC8, 0xC8); // 比贴图稍深，与已揭开区域区分
+    case Flag:
+        return qRgb(0xD3, 0x2F, 0x2F);
+    case Mine:
+        return qRgb(0xB7, 0x1C, 0x1C);
+    case Blank:
+        return qRgb(0xF4, 0xF4, 0xF4);
+    default:
+        return numberColor(tile - Number1 + 1).lighter(160).rgb();
+    }
+}
+
+QRect TileAtlas::sourceRect(Tile tile) const
+{
+    return QRect(tile * m_tilePixels, 0, m_tilePixels, m_tilePixels);
+}
+
+void TileAtlas::paintTile(QPainter &painter, Tile tile, const QRect &rect) const
+{
+    QColor background;
+    QColor border("#BBBBBB");
+    QColor textColor = Qt::black;
+    QString text;
+
+    switch (tile) {
+    case Flag:
+        // 显示旗帜
+        background = QColor("#E0E0E0");
+        textColor = QColor("#D32F2F");
+        text = QStringLiteral("🚩");
+        break;
+    case Hidden:
+        // 未揭开的单元格
+        background = QColor("#F0F0F0");
+        break;
+    case Hover:
+        // 悬停效果
+        background = QColor("#E0E0E0");
+        break;
+    case Mine:
+        // 揭开的地雷
+        background = QColor("#FFCDD2");
+        textColor = QColor("#B71C1C");
+        text = QStringLiteral("💣");
+        break;
+    case Blank:
+        // 揭开的空白单元格，稍暗的背景和不同的边框
+        background = QColor("#E8E8E8");
+        border = QColor("#DDDDDD");
+        break;
+    default: {
+        // 揭开的数字
+        const int count = tile - Number1 + 1;
+        background = Qt::white;
+        textColor = numberColor(count);
+        text = QString::number(count);
+        break;
+    }
+    }
+
+    painter.fillRect(rect, background);
+    painter.setPen(border);
+    painter.drawRect(rect.adjusted(0, 0, -1, -1));
+
+    if (!text.isEmpty()) {
+        painter.setPen(textColor);
+        painter.drawText(rect, Qt::AlignCenter, text);
+    }
+}
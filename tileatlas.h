@@ -0,0 +1,48 @@
+#ifndef TILEATLAS_H
+#define TILEATLAS_H
+
+#include <QPixmap>
+#include <QRect>
+#include <QColor>
+#include <cstdint>
+
+// 预先绘制好的单元格贴图集：每种外观一块，横向排成一张图。
+// 按单元格大小和设备像素比构建一次，绘制时直接贴图，
+// 不再为每个单元格拼接样式表或解析字体回退
+class TileAtlas
+{
+public:
+    enum Tile {
+        Hidden = 0,
+        Hover,
+        Flag,
+        Mine,
+        Blank,
+        Number1,  // Number1 + (n - 1) 为数字 n
+        TileCount = Number1 + 8
+    };
+
+    // 尺寸或像素比变化时重新构建，返回是否发生了重建
+    bool ensure(int cellSize, qreal devicePixelRatio);
+
+    // 根据引擎单元格状态选择贴图
+    static Tile tileFor(std::uint8_t state, bool hover);
+
+    // 缩小到看不清贴图时，每种贴图对应的单一颜色
+    static QRgb coarseColor(Tile tile);
+
+    const QPixmap &pixmap() const { return m_pixmap; }
+    // 贴图在图集中的位置（设备像素）
+    QRect sourceRect(Tile tile) const;
+    int cellSize() const { return m_cellSize; }
+
+private:
+    QPixmap m_pixmap;
+    int m_cellSize = 0;
+    qreal m_devicePixelRatio = 0;
+    int m_tilePixels = 0;
+
+    void paintTile(QPainter &painter, Tile tile, const QRect &rect) const;
+};
+
+#endif // TILEATLAS_H
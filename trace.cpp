@@ -0,0 +1,360 @@
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace Trace {
+
+namespace detail {
+std::atomic<bool> enabled{false};
+}
+
+namespace {
+
+const int MaxDepth = 64;
+const int LatencyBuckets = 256; // 每个2的幂4个桶（纳秒）
+const char SpanCategory[] = "span";
+
+struct Event {
+    const char *name;
+    const char *category;
+    const char *detail;
+    std::int64_t start;
+    std::int64_t duration;
+};
+
+// 一个线程的环形缓冲区。只有所属线程写入，导出时由其他线程读取，
+// 因此每次写入加一次不会有竞争的锁
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::vector<Event> events;
+    std::size_t next = 0;
+    bool wrapped = false;
+    int tid = 0;
+    std::string name;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers; // 线程退出后仍保留，供导出
+    int nextTid = 1;
+
+    struct Pending {
+        const char *action;
+        std::int64_t start;
+    };
+    std::vector<Pending> pending;
+    std::map<std::string, std::vector<long long>> latency;
+    long long stalls = 0;
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+struct ThreadState {
+    std::shared_ptr<ThreadBuffer> buffer;
+    const char *name = nullptr;
+    const char *stack[MaxDepth];
+    int depth = 0;
+};
+
+thread_local ThreadState t_state;
+
+// 首次记录时分配并登记缓冲区，之后写入不再分配内存
+ThreadBuffer &threadBuffer()
+{
+    if (!t_state.buffer) {
+        auto buffer = std::make_shared<ThreadBuffer>();
+        buffer->events.resize(BufferEvents);
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        buffer->tid = r.nextTid++;
+        buffer->name = t_state.name ? t_state.name : "thread " + std::to_string(buffer->tid);
+        r.buffers.push_back(buffer);
+        t_state.buffer = std::move(buffer);
+    }
+    return *t_state.buffer;
+}
+
+int latencyBucket(std::int64_t ns)
+{
+    return ns < 1 ? 0 : std::min(LatencyBuckets - 1, static_cast<int>(std::log2(double(ns)) * 4));
+}
+
+// 桶的几何中点，毫秒
+double bucketMs(int bucket)
+{
+    return std::exp2((bucket + 0.5) / 4.0) / 1e6;
+}
+
+double percentileMs(const std::vector<long long> &buckets, long long total, double p)
+{
+    const long long rank = std::max(1LL, static_cast<long long>(std::ceil(p * total)));
+    long long seen = 0;
+    for (int i = 0; i < LatencyBuckets; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return bucketMs(i);
+        }
+    }
+    return 0;
+}
+
+void writeString(std::ostream &out, const char *text)
+{
+    out << '"';
+    for (const char *p = text; *p; ++p) {
+        if (*p == '"' || *p == '\\') {
+            out << '\\';
+        }
+        out << *p;
+    }
+    out << '"';
+}
+
+} // namespace
+
+void setEnabled(bool enabled)
+{
+    detail::enabled.store(enabled, std::memory_order_relaxed);
+}
+
+std::int64_t now()
+{
+    static const auto epoch = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void setThreadName(const char *name)
+{
+    t_state.name = name;
+    if (t_state.buffer) {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        t_state.buffer->name = name;
+    }
+}
+
+void complete(const char *name, const char *category, std::int64_t start, std::int64_t duration, const char *detail)
+{
+    ThreadBuffer &buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events[buffer.next] = {name, category, detail, start, duration};
+    if (++buffer.next == buffer.events.size()) {
+        buffer.next = 0;
+        buffer.wrapped = true;
+    }
+}
+
+const char *activeSpan()
+{
+    const int depth = std::min(t_state.depth, MaxDepth);
+    return depth > 0 ? t_state.stack[depth - 1] : nullptr;
+}
+
+void Span::begin()
+{
+    if (t_state.depth < MaxDepth) {
+        t_state.stack[t_state.depth] = m_name;
+    }
+    t_state.depth++;
+    m_start = now();
+}
+
+void Span::end()
+{
+    const std::int64_t finished = now();
+    t_state.depth--;
+    complete(m_name, SpanCategory, m_start, finished - m_start);
+}
+
+void stall(std::int64_t start, std::int64_t duration)
+{
+    if (!enabled()) {
+        return;
+    }
+
+    // 卡顿期间重叠最长的区间通常就是最外层的那个耗时操作
+    const char *cause = "(untraced)";
+    {
+        ThreadBuffer &buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        const std::size_t count = buffer.wrapped ? buffer.events.size() : buffer.next;
+        std::int64_t longest = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            const Event &event = buffer.events[i];
+            if (event.category != SpanCategory) {
+                continue;
+            }
+            const std::int64_t overlap = std::min(event.start + event.duration, start + duration)
+                                         - std::max(event.start, start);
+            if (overlap > longest) {
+                longest = overlap;
+                cause = event.name;
+            }
+        }
+    }
+    complete("stall", "stall", start, duration, cause);
+
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.stalls++;
+}
+
+void beginInteraction(const char *action)
+{
+    if (!enabled()) {
+        return;
+    }
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.pending.push_back({action, now()});
+}
+
+void endInteraction()
+{
+    if (!enabled()) {
+        return;
+    }
+    Registry &r = registry();
+    std::vector<Registry::Pending> finished;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (r.pending.empty()) {
+            return;
+        }
+        finished.swap(r.pending);
+    }
+
+    const std::int64_t painted = now();
+    for (const Registry::Pending &p : finished) {
+        complete(p.action, "input", p.start, painted - p.start);
+    }
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const Registry::Pending &p : finished) {
+        std::vector<long long> &buckets = r.latency[p.action];
+        buckets.resize(LatencyBuckets, 0);
+        buckets[latencyBucket(painted - p.start)]++;
+    }
+}
+
+std::vector<LatencyStats> latencyStats()
+{
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    std::vector<LatencyStats> result;
+    for (const auto &entry : r.latency) {
+        LatencyStats stats;
+        stats.action = entry.first;
+        for (long long count : entry.second) {
+            stats.count += count;
+        }
+        if (stats.count == 0) {
+            continue;
+        }
+        stats.p50Ms = percentileMs(entry.second, stats.count, 0.5);
+        stats.p90Ms = percentileMs(entry.second, stats.count, 0.9);
+        stats.p99Ms = percentileMs(entry.second, stats.count, 0.99);
+        stats.maxMs = percentileMs(entry.second, stats.count, 1.0);
+        result.push_back(stats);
+    }
+    return result;
+}
+
+long long stallCount()
+{
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.stalls;
+}
+
+void clear()
+{
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const std::shared_ptr<ThreadBuffer> &buffer : r.buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->next = 0;
+        buffer->wrapped = false;
+    }
+    r.pending.clear();
+    r.latency.clear();
+    r.stalls = 0;
+}
+
+void writeChromeTrace(std::ostream &out)
+{
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        buffers = registry().buffers;
+    }
+
+    char number[160];
+    bool first = true;
+    auto separator = [&] {
+        out << (first ? "\n    " : ",\n    ");
+        first = false;
+    };
+
+    out << "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [";
+    for (const std::shared_ptr<ThreadBuffer> &buffer : buffers) {
+        // 复制出来再输出，不在持锁时做格式化
+        std::vector<Event> events;
+        std::string name;
+        {
+            std::lock_guard<std::mutex> lock(buffer->mutex);
+            if (buffer->wrapped) {
+                events.assign(buffer->events.begin() + buffer->next, buffer->events.end());
+            }
+            events.insert(events.end(), buffer->events.begin(), buffer->events.begin() + buffer->next);
+        }
+        {
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            name = buffer->name;
+        }
+        if (events.empty()) {
+            continue;
+        }
+
+        separator();
+        out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->tid
+            << ", \"args\": {\"name\": ";
+        writeString(out, name.c_str());
+        out << "}}";
+        for (const Event &event : events) {
+            separator();
+            out << "{\"name\": ";
+            writeString(out, event.name);
+            out << ", \"cat\": ";
+            writeString(out, event.category);
+            std::snprintf(number, sizeof(number), ", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f",
+                          event.start / 1000.0, event.duration / 1000.0);
+            out << number << ", \"pid\": 1, \"tid\": " << buffer->tid;
+            if (event.detail) {
+                out << ", \"args\": {\"cause\": ";
+                writeString(out, event.detail);
+                out << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n  ],\n  \"otherData\": {\n    \"stalls\": \"" << stallCount() << "\"";
+    for (const LatencyStats &stats : latencyStats()) {
+        std::snprintf(number, sizeof(number), "n=%lld p50=%.2fms p90=%.2fms p99=%.2fms max=%.2fms",
+                      stats.count, stats.p50Ms, stats.p90Ms, stats.p99Ms, stats.maxMs);
+        out << ",\n    ";
+        writeString(out, ("latency " + stats.action).c_str());
+        out << ": ";
+        writeString(out, number);
+    }
+    out << "\n  }\n}\n";
+}
+
+} // namespace Trace
@@ -0,0 +1,102 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 运行时可开关的轻量跟踪。TRACE_SPAN 在作用域结束时把（名称，起止时间）
+// 写入当前线程的环形缓冲区；关闭时只有一次原子读和一个分支。
+// 名称只保存指针，必须是字符串常量。记录可导出为 Chrome trace JSON，
+// 用 chrome://tracing 或 Perfetto 打开
+namespace Trace {
+
+// 每个线程保留的最近事件数，更早的事件被覆盖
+const int BufferEvents = 1 << 16;
+
+// 事件循环一次忙碌超过一帧即视为卡顿
+const std::int64_t StallThresholdNs = 16000000;
+
+namespace detail {
+extern std::atomic<bool> enabled;
+}
+
+inline bool enabled() { return detail::enabled.load(std::memory_order_relaxed); }
+void setEnabled(bool enabled);
+
+// 单调时钟，纳秒
+std::int64_t now();
+
+// 当前线程在导出结果中显示的名称
+void setThreadName(const char *name);
+
+// 在当前线程上记录一个完整事件，category 如 "span"、"input"、"stall"
+void complete(const char *name, const char *category, std::int64_t start, std::int64_t duration,
+              const char *detail = nullptr);
+
+// 当前线程最内层的活动区间，没有时为空指针
+const char *activeSpan();
+
+// 当前线程的事件循环在 [start, start + duration) 内没有响应：
+// 记录一个卡顿事件，原因取这段时间内重叠最长的已完成区间
+void stall(std::int64_t start, std::int64_t duration);
+
+// 输入到绘制的延迟：改变了画面的输入调用 beginInteraction，
+// 下一次绘制完成时调用 endInteraction，其间的输入按动作分别统计
+void beginInteraction(const char *action);
+void endInteraction();
+
+struct LatencyStats {
+    std::string action;
+    long long count = 0;
+    double p50Ms = 0;
+    double p90Ms = 0;
+    double p99Ms = 0;
+    double maxMs = 0;
+};
+std::vector<LatencyStats> latencyStats();
+long long stallCount();
+
+// 清空所有线程的事件和统计
+void clear();
+
+// 导出为 Chrome trace 的 JSON 对象格式，附带延迟统计
+void writeChromeTrace(std::ostream &out);
+
+// 作用域区间，由 TRACE_SPAN 创建
+class Span
+{
+public:
+    explicit Span(const char *name) : m_name(enabled() ? name : nullptr)
+    {
+        if (m_name) {
+            begin();
+        }
+    }
+    ~Span()
+    {
+        if (m_name) {
+            end();
+        }
+    }
+
+    Span(const Span &) = delete;
+    Span &operator=(const Span &) = delete;
+
+private:
+    const char *m_name;
+    std::int64_t m_start = 0;
+
+    void begin();
+    void end();
+};
+
+} // namespace Trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SPAN(name) Trace::Span TRACE_CONCAT(traceSpan, __LINE__)(name)
+
+#endif // TRACE_H
@@ -0,0 +1,243 @@
+#include "undolog.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// 记录格式：标记数增量、剩余安全格增量（zigzag 变长整数）、前后的胜负状态（1字节）、
+// 单元格数，之后每格一个变长整数 (zigzag(下标差) << 4) | (旧状态 << 2) | 新状态
+enum GameState : std::uint8_t {
+    OverBit = 1,
+    WonBit = 2
+};
+
+inline void putVarint(std::vector<std::uint8_t> &out, std::uint64_t value)
+{
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+// 只解码自己写入的记录，不需要边界检查
+inline std::uint64_t getVarint(const std::uint8_t *&data)
+{
+    std::uint64_t result = 0;
+    for (int shift = 0;; shift += 7) {
+        const std::uint8_t byte = *data++;
+        result |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return result;
+        }
+    }
+}
+
+inline std::uint64_t zigzag(std::int64_t value)
+{
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t unzigzag(std::uint64_t value)
+{
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+inline std::uint8_t visibleState(std::uint8_t cell)
+{
+    return ((cell & BoardEngine::RevealedBit) ? BoardEngine::Shown : BoardEngine::Hidden)
+           | ((cell & BoardEngine::FlaggedBit) ? BoardEngine::Flagged : BoardEngine::Hidden);
+}
+
+inline std::uint8_t gameState(const BoardEngine &engine)
+{
+    return (engine.isGameOver() ? OverBit : 0) | (engine.isGameWon() ? WonBit : 0);
+}
+
+} // namespace
+
+void UndoLog::setCapacity(std::size_t bytes)
+{
+    clear();
+    m_capacity = bytes;
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+}
+
+void UndoLog::clear()
+{
+    m_entries.clear();
+    m_cursor = 0;
+    m_head = 0;
+    m_used = 0;
+    m_recording = false;
+}
+
+void UndoLog::begin(BoardEngine &engine)
+{
+    m_recording = true;
+    m_flaggedBefore = engine.flaggedCount();
+    m_hiddenSafeBefore = engine.hiddenSafeCells();
+    m_stateBefore = gameState(engine);
+    engine.beginJournal();
+}
+
+bool UndoLog::commit(BoardEngine &engine)
+{
+    if (!m_recording) {
+        return false;
+    }
+    TRACE_SPAN("UndoLog::commit");
+    m_recording = false;
+    engine.endJournal();
+
+    // 同一单元格只保留第一次的旧状态（暂存在每格2位的平面里）和最终的新状态
+    const std::vector<std::uint32_t> &journal = engine.journal();
+    const std::vector<std::uint8_t> &cells = engine.cells();
+    m_seen.resize((cells.size() + 63) / 64);
+    m_before.resize((cells.size() + 31) / 32);
+    m_order.clear();
+    for (std::uint32_t entry : journal) {
+        const int index = BoardEngine::journalIndex(entry);
+        std::uint64_t &word = m_seen[index / 64];
+        const std::uint64_t bit = std::uint64_t(1) << (index % 64);
+        if (word & bit) {
+            continue;
+        }
+        word |= bit;
+        const int shift = 2 * (index % 32);
+        std::uint64_t &before = m_before[index / 32];
+        before = (before & ~(std::uint64_t(3) << shift))
+                 | (static_cast<std::uint64_t>(BoardEngine::journalOldState(entry)) << shift);
+        m_order.push_back(index);
+    }
+
+    // 按下标升序编码，连锁展开的相邻格差值小，一般每格1字节。
+    // 变化的格子少时直接排序，多时按位图顺序收集，避免排序的对数因子
+    if (m_order.size() * 8 < m_seen.size()) {
+        std::sort(m_order.begin(), m_order.end());
+    } else {
+        m_order.clear();
+        for (std::size_t w = 0; w < m_seen.size(); ++w) {
+            std::uint64_t bits = m_seen[w];
+            for (int bit = 0; bits; ++bit, bits >>= 1) {
+                if (bits & 1) {
+                    m_order.push_back(static_cast<int>(w * 64 + bit));
+                }
+            }
+        }
+    }
+
+    m_scratch.clear();
+    std::uint64_t count = 0;
+    int previous = 0;
+    for (int index : m_order) {
+        m_seen[index / 64] = 0;
+        const std::uint8_t oldState = (m_before[index / 32] >> (2 * (index % 32))) & 3;
+        const std::uint8_t newState = visibleState(cells[index]);
+        if (oldState == newState) {
+            continue;
+        }
+        putVarint(m_scratch, (zigzag(index - previous) << 4) | (oldState << 2) | newState);
+        previous = index;
+        ++count;
+    }
+
+    const int flaggedDelta = engine.flaggedCount() - m_flaggedBefore;
+    const int hiddenSafeDelta = engine.hiddenSafeCells() - m_hiddenSafeBefore;
+    const std::uint8_t stateAfter = gameState(engine);
+    if (count == 0 && flaggedDelta == 0 && hiddenSafeDelta == 0 && stateAfter == m_stateBefore) {
+        return false;
+    }
+
+    // 单元格数要编码完才知道，记录头最后补到前面
+    std::vector<std::uint8_t> header;
+    putVarint(header, zigzag(flaggedDelta));
+    putVarint(header, zigzag(hiddenSafeDelta));
+    header.push_back(static_cast<std::uint8_t>(m_stateBefore | (stateAfter << 2)));
+    putVarint(header, count);
+    m_scratch.insert(m_scratch.begin(), header.begin(), header.end());
+
+    // 新的一步让重做的历史失效
+    while (m_entries.size() > m_cursor) {
+        m_used -= m_entries.back().size;
+        m_entries.pop_back();
+    }
+    m_head = m_entries.empty() ? 0 : m_entries.back().offset + m_entries.back().size;
+
+    if (m_scratch.size() > m_capacity) {
+        clear();
+        return false;
+    }
+    store(m_scratch.data(), m_scratch.size());
+    return true;
+}
+
+void UndoLog::store(const std::uint8_t *data, std::size_t size)
+{
+    // 记录不跨越缓冲区末尾：放不下时从头开始写，末尾剩下的空隙连同其中的旧记录一起丢弃
+    const std::size_t position = m_head + size <= m_capacity ? m_head : 0;
+    const bool wrapped = position != m_head;
+    while (!m_entries.empty()) {
+        const Entry &oldest = m_entries.front();
+        const bool overlaps = oldest.offset < position + size && position < oldest.offset + oldest.size;
+        if (!overlaps && !(wrapped && oldest.offset >= m_head)) {
+            break;
+        }
+        m_used -= oldest.size;
+        m_entries.pop_front();
+    }
+
+    // 缓冲区在写满一圈之前按需增长，实际占用与历史长度成正比
+    if (position + size > m_buffer.size()) {
+        m_buffer.resize(std::min(m_capacity, std::max(position + size, m_buffer.size() * 2)));
+    }
+    std::memcpy(m_buffer.data() + position, data, size);
+    m_entries.push_back({position, size});
+    m_cursor = m_entries.size();
+    m_head = position + size;
+    m_used += size;
+}
+
+bool UndoLog::undo(BoardEngine &engine)
+{
+    if (!canUndo() || m_recording) {
+        return false;
+    }
+    TRACE_SPAN("UndoLog::undo");
+    apply(engine, m_entries[--m_cursor], false);
+    return true;
+}
+
+bool UndoLog::redo(BoardEngine &engine)
+{
+    if (!canRedo() || m_recording) {
+        return false;
+    }
+    TRACE_SPAN("UndoLog::redo");
+    apply(engine, m_entries[m_cursor++], true);
+    return true;
+}
+
+void UndoLog::apply(BoardEngine &engine, const Entry &entry, bool forward) const
+{
+    const std::uint8_t *data = m_buffer.data() + entry.offset;
+    const int flaggedDelta = static_cast<int>(unzigzag(getVarint(data)));
+    const int hiddenSafeDelta = static_cast<int>(unzigzag(getVarint(data)));
+    const std::uint8_t states = *data++;
+    const std::uint64_t count = getVarint(data);
+
+    // 每个单元格在一条记录里只出现一次，应用顺序无关
+    int index = 0;
+    for (std::uint64_t i = 0; i < count; ++i) {
+        const std::uint64_t packed = getVarint(data);
+        index += static_cast<int>(unzigzag(packed >> 4));
+        const std::uint8_t state = forward ? (packed & 3) : ((packed >> 2) & 3);
+        engine.setVisibleState(index, static_cast<BoardEngine::VisibleState>(state));
+    }
+
+    const std::uint8_t state = forward ? (states >> 2) : (states & 3);
+    const int sign = forward ? 1 : -1;
+    engine.restoreCounters(sign * flaggedDelta, sign * hiddenSafeDelta, state & OverBit, state & WonBit);
+}
@@ -0,0 +1,74 @@
+#ifndef UNDOLOG_H
+#define UNDOLOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+#include "boardengine.h"
+
+// 撤销/重做历史：每一步只保存它改变的单元格（下标差和前后的可见状态，
+// 变长编码，连锁展开的相邻格一般每格1字节）以及计数器和胜负状态的变化，
+// 从不保存整盘快照。记录放在容量固定的环形缓冲区里，空间不够时丢弃最旧的步骤；
+// 撤销和重做的耗时只与这一步改变的单元格数成正比
+class UndoLog
+{
+public:
+    static const std::size_t DefaultCapacity = std::size_t(16) << 20;
+
+    explicit UndoLog(std::size_t capacity = DefaultCapacity) : m_capacity(capacity) {}
+
+    // 修改容量会清空历史
+    void setCapacity(std::size_t bytes);
+    std::size_t capacity() const { return m_capacity; }
+    std::size_t memoryUsed() const { return m_used; }
+
+    void clear();
+
+    // 在一步操作之前调用 begin，操作（包括分步展开）全部完成后调用 commit。
+    // 这一步没有改变任何东西时不记录；比整个容量还大的一步无法撤销，
+    // 这时之前的历史也一并清空，返回 false
+    void begin(BoardEngine &engine);
+    bool commit(BoardEngine &engine);
+    bool isRecording() const { return m_recording; }
+
+    bool canUndo() const { return m_cursor > 0; }
+    bool canRedo() const { return m_cursor < m_entries.size(); }
+    std::size_t undoDepth() const { return m_cursor; }
+    std::size_t redoDepth() const { return m_entries.size() - m_cursor; }
+
+    // 变化记入引擎的变更集，观察者只需重绘这些单元格。
+    // 调用前引擎不能有进行中的分步揭示
+    bool undo(BoardEngine &engine);
+    bool redo(BoardEngine &engine);
+
+private:
+    struct Entry {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    std::size_t m_capacity;
+    std::size_t m_used = 0;
+    std::vector<std::uint8_t> m_buffer; // 环形缓冲区，按需增长到 m_capacity
+    std::size_t m_head = 0;             // 下一条记录的写入位置
+    std::deque<Entry> m_entries;        // 从旧到新；m_cursor 之后的是可以重做的步骤
+    std::size_t m_cursor = 0;
+
+    // begin 时的状态
+    bool m_recording = false;
+    int m_flaggedBefore = 0;
+    int m_hiddenSafeBefore = 0;
+    std::uint8_t m_stateBefore = 0;
+
+    // 编码和去重用的缓冲区，跨步骤复用
+    std::vector<std::uint8_t> m_scratch;
+    std::vector<std::uint64_t> m_seen;
+    std::vector<std::uint64_t> m_before;
+    std::vector<int> m_order;
+
+    void store(const std::uint8_t *data, std::size_t size);
+    void apply(BoardEngine &engine, const Entry &entry, bool forward) const;
+};
+
+#endif // UNDOLOG_H